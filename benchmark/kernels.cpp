@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <benchmark/benchmark.h>
+#include <boost/make_shared.hpp>
+#include <pinocchio/algorithm/center-of-mass.hpp>
+#include <pinocchio/algorithm/frames.hpp>
+#include <pinocchio/algorithm/kinematics.hpp>
+
+#include "synthetic_messages.h"
+#include "whole_body_state_rviz_plugin/ContactFrames.h"
+#include "whole_body_state_rviz_plugin/ConvexHull.h"
+#include "whole_body_state_rviz_plugin/JointConfigurationMapper.h"
+#include "whole_body_state_rviz_plugin/LinkFrames.h"
+#include "whole_body_state_rviz_plugin/TrajectorySeries.h"
+#include "whole_body_state_rviz_plugin/WholeBodyStateProcessor.h"
+
+using namespace whole_body_state_rviz_plugin;
+
+// Decoding of the joint positions into the configuration vector
+static void BM_JointMapping(benchmark::State &state) {
+  const std::size_t num_joints = state.range(0);
+  pinocchio::Model model;
+  synthetic::buildSyntheticModel(num_joints, model);
+  whole_body_state_msgs::WholeBodyState msg;
+  synthetic::buildSyntheticState(num_joints, 4, 0., msg);
+  JointConfigurationMapper mapper;
+  mapper.setModel(model);
+  Eigen::VectorXd q = pinocchio::neutral(model);
+  for (auto _ : state) {
+    mapper.fillConfiguration(msg, q);
+    benchmark::DoNotOptimize(q.data());
+  }
+}
+BENCHMARK(BM_JointMapping)->Arg(12)->Arg(30)->Arg(60);
+
+// Center of mass and forward kinematics of all the frames
+static void BM_ForwardKinematicsCoM(benchmark::State &state) {
+  const std::size_t num_joints = state.range(0);
+  pinocchio::Model model;
+  synthetic::buildSyntheticModel(num_joints, model);
+  pinocchio::Data data(model);
+  const Eigen::VectorXd q = pinocchio::neutral(model);
+  for (auto _ : state) {
+    pinocchio::centerOfMass(model, data, q);
+    pinocchio::framesForwardKinematics(model, data, q);
+    benchmark::DoNotOptimize(data.oMf.data());
+  }
+}
+BENCHMARK(BM_ForwardKinematicsCoM)->Arg(12)->Arg(30)->Arg(60);
+
+// Center of mass and placements of the link frames only, as done by the processor, which reuses the kinematics of
+// the center of mass
+static void BM_LinkKinematicsCoM(benchmark::State &state) {
+  const std::size_t num_joints = state.range(0);
+  pinocchio::Model model;
+  synthetic::buildSyntheticModel(num_joints, model);
+  pinocchio::Data data(model);
+  LinkFrames link_frames;
+  link_frames.setModel(model);
+  LinkFrames::FramePlacements placements;
+  const Eigen::VectorXd q = pinocchio::neutral(model);
+  for (auto _ : state) {
+    pinocchio::centerOfMass(model, data, q);
+    link_frames.computePlacements(model, data, placements);
+    benchmark::DoNotOptimize(placements.data());
+  }
+}
+BENCHMARK(BM_LinkKinematicsCoM)->Arg(12)->Arg(30)->Arg(60);
+
+// Contact orientations and centers of pressure
+static void BM_ContactKernels(benchmark::State &state) {
+  const std::size_t num_contacts = state.range(0);
+  whole_body_state_msgs::WholeBodyState msg;
+  synthetic::buildSyntheticState(0, num_contacts, 0., msg);
+  ContactFrames frames;
+  Eigen::Matrix4Xd contact_orientations, force_orientations, cone_orientations;
+  Eigen::Matrix3Xd cops;
+  for (auto _ : state) {
+    frames.fill(msg.contacts);
+    computeRotationsFromTwoVectors(Eigen::Vector3d::UnitZ(), frames.normals, contact_orientations);
+    computeRotationsFromTwoVectors(-Eigen::Vector3d::UnitZ(), frames.forces, force_orientations);
+    computeRotationsFromTwoVectors(-Eigen::Vector3d::UnitY(), frames.normals, cone_orientations);
+    computeCentersOfPressure(frames.forces, frames.torques, cops);
+    benchmark::DoNotOptimize(cops.data());
+  }
+}
+BENCHMARK(BM_ContactKernels)->Arg(2)->Arg(4)->Arg(8)->Arg(16);
+
+// Convex hull of the support region
+static void BM_SupportHull(benchmark::State &state) {
+  const std::size_t num_points = state.range(0);
+  std::vector<Eigen::Vector2d> points(num_points);
+  for (std::size_t i = 0; i < num_points; ++i) {
+    points[i] = Eigen::Vector2d::Random();
+  }
+  std::vector<std::size_t> hull;
+  for (auto _ : state) {
+    computeConvexHull(points, hull);
+    benchmark::DoNotOptimize(hull.data());
+  }
+}
+BENCHMARK(BM_SupportHull)->Arg(4)->Arg(8)->Arg(16)->Arg(64);
+
+// Whole state pipeline: kinematics, contacts, support region, ZMP, ICP and CMP. The messages alternate between two
+// postures, so the kinematics run every iteration.
+static void BM_ProcessState(benchmark::State &state) {
+  const std::size_t num_joints = state.range(0);
+  const std::size_t num_contacts = state.range(1);
+  boost::shared_ptr<pinocchio::Model> model = boost::make_shared<pinocchio::Model>();
+  synthetic::buildSyntheticModel(num_joints, *model);
+  whole_body_state_msgs::WholeBodyState msgs[2];
+  synthetic::buildSyntheticState(num_joints, num_contacts, 0., msgs[0]);
+  synthetic::buildSyntheticState(num_joints, num_contacts, 0.5, msgs[1]);
+  WholeBodyStateProcessor processor;
+  processor.setModel(model);
+  ProcessingParameters params;
+  params.com_real = false;
+  WholeBodyStateSnapshot snapshot;
+  std::size_t i = 0;
+  for (auto _ : state) {
+    processor.process(msgs[i++ % 2], params, snapshot);
+    benchmark::DoNotOptimize(snapshot.zmp.data());
+  }
+}
+BENCHMARK(BM_ProcessState)->Args({12, 4})->Args({30, 4})->Args({60, 4})->Args({30, 8})->Args({30, 16});
+
+// Whole state pipeline with an unchanged posture, which skips the kinematics
+static void BM_ProcessSamePosture(benchmark::State &state) {
+  const std::size_t num_joints = state.range(0);
+  const std::size_t num_contacts = state.range(1);
+  boost::shared_ptr<pinocchio::Model> model = boost::make_shared<pinocchio::Model>();
+  synthetic::buildSyntheticModel(num_joints, *model);
+  whole_body_state_msgs::WholeBodyState msg;
+  synthetic::buildSyntheticState(num_joints, num_contacts, 0., msg);
+  WholeBodyStateProcessor processor;
+  processor.setModel(model);
+  ProcessingParameters params;
+  params.com_real = false;
+  WholeBodyStateSnapshot snapshot;
+  for (auto _ : state) {
+    processor.process(msg, params, snapshot);
+    benchmark::DoNotOptimize(snapshot.zmp.data());
+  }
+}
+BENCHMARK(BM_ProcessSamePosture)->Args({12, 4})->Args({30, 4})->Args({60, 4});
+
+// Sampling of the trajectory series and of the vertices of their axes, as done by the trajectory display
+static void BM_TrajectorySampling(benchmark::State &state) {
+  const std::size_t horizon = state.range(0);
+  whole_body_state_msgs::WholeBodyTrajectory msg;
+  synthetic::buildSyntheticTrajectory(30, 4, horizon, msg);
+  const Eigen::Vector3d position(0.1, -0.2, 0.3);
+  const Eigen::Quaterniond orientation(Eigen::AngleAxisd(0.5, Eigen::Vector3d::UnitZ()));
+  TrajectorySeries com_knots;
+  std::vector<TrajectorySeries> contact_knots;
+  TrajectorySeries axes;
+  Eigen::Matrix3Xd vertices;
+  for (auto _ : state) {
+    sampleCoMTrajectory(msg.trajectory, position, orientation, com_knots);
+    sampleContactTrajectories(msg.trajectory, position, orientation, contact_knots);
+    sampleAxes(com_knots, 1., 100, axes);
+    computeAxesVertices(axes, 0.04, vertices);
+    for (std::size_t i = 0; i < contact_knots.size(); ++i) {
+      sampleAxes(contact_knots[i], 1., 100, axes);
+      computeAxesVertices(axes, 0.04, vertices);
+    }
+    benchmark::DoNotOptimize(vertices.data());
+  }
+  state.SetItemsProcessed(state.iterations() * horizon);
+}
+BENCHMARK(BM_TrajectorySampling)->Arg(50)->Arg(200)->Arg(1000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,496 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+// Replays synthetic messages through the visuals of the whole-body state and trajectory displays, and reports the
+// scene nodes and movable objects created per message together with the wall time of the visual updates.
+//
+// Ogre is started through the rviz render system, which only needs an X display for its hidden dummy window. No GPU
+// is required if it runs under a virtual frame buffer with a software renderer, e.g.
+//   xvfb-run -a rosrun whole_body_state_rviz_plugin whole_body_state_rviz_plugin_scene_graph_benchmark
+
+#include <OgreEntity.h>
+#include <OgreManualObject.h>
+#include <OgreResourceGroupManager.h>
+#include <OgreRoot.h>
+#include <OgreSceneManager.h>
+#include <OgreSceneManagerEnumerator.h>
+#include <OgreSceneNode.h>
+#include <boost/make_shared.hpp>
+#include <rviz/ogre_helpers/billboard_line.h>
+#include <rviz/ogre_helpers/render_system.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "synthetic_messages.h"
+#include "whole_body_state_rviz_plugin/ArrowVisual.h"
+#include "whole_body_state_rviz_plugin/AxesListVisual.h"
+#include "whole_body_state_rviz_plugin/ConeVisual.h"
+#include "whole_body_state_rviz_plugin/PointVisual.h"
+#include "whole_body_state_rviz_plugin/PolygonVisual.h"
+#include "whole_body_state_rviz_plugin/TrajectorySeries.h"
+#include "whole_body_state_rviz_plugin/VisualPool.h"
+#include "whole_body_state_rviz_plugin/WholeBodyStateProcessor.h"
+
+using namespace whole_body_state_rviz_plugin;
+
+namespace {
+
+/** @brief Number of scene nodes and movable objects created by the scene manager */
+struct CreationCounts {
+  CreationCounts() : scene_nodes(0), entities(0), manual_objects(0), other_objects(0) {}
+
+  CreationCounts operator-(const CreationCounts &other) const {
+    CreationCounts counts;
+    counts.scene_nodes = scene_nodes - other.scene_nodes;
+    counts.entities = entities - other.entities;
+    counts.manual_objects = manual_objects - other.manual_objects;
+    counts.other_objects = other_objects - other.other_objects;
+    return counts;
+  }
+
+  std::size_t scene_nodes;     //!< Created scene nodes
+  std::size_t entities;        //!< Created entities, i.e. rviz shapes
+  std::size_t manual_objects;  //!< Created manual objects
+  std::size_t other_objects;   //!< Created movable objects of any other type, e.g. billboard chains
+};
+
+/**
+ * @class CountingSceneManager
+ * @brief Generic scene manager that counts the scene nodes and movable objects created through it
+ * Every creation method of Ogre ends up in createSceneNodeImpl() or createMovableObject(), so the counts include the
+ * objects created by rviz helpers such as shapes and billboard lines.
+ */
+class CountingSceneManager : public Ogre::DefaultSceneManager {
+ public:
+  static const Ogre::String FACTORY_TYPE_NAME;
+
+  explicit CountingSceneManager(const Ogre::String &name) : Ogre::DefaultSceneManager(name) {}
+
+  const Ogre::String &getTypeName() const override { return FACTORY_TYPE_NAME; }
+
+  using Ogre::SceneManager::createMovableObject;
+  Ogre::MovableObject *createMovableObject(const Ogre::String &name, const Ogre::String &type_name,
+                                           const Ogre::NameValuePairList *params) override {
+    if (type_name == Ogre::EntityFactory::FACTORY_TYPE_NAME) {
+      ++counts_.entities;
+    } else if (type_name == Ogre::ManualObjectFactory::FACTORY_TYPE_NAME) {
+      ++counts_.manual_objects;
+    } else {
+      ++counts_.other_objects;
+    }
+    return Ogre::DefaultSceneManager::createMovableObject(name, type_name, params);
+  }
+
+  /** @brief Return the number of objects created so far */
+  const CreationCounts &getCounts() const { return counts_; }
+
+ protected:
+  Ogre::SceneNode *createSceneNodeImpl() override {
+    ++counts_.scene_nodes;
+    return Ogre::DefaultSceneManager::createSceneNodeImpl();
+  }
+
+  Ogre::SceneNode *createSceneNodeImpl(const Ogre::String &name) override {
+    ++counts_.scene_nodes;
+    return Ogre::DefaultSceneManager::createSceneNodeImpl(name);
+  }
+
+ private:
+  CreationCounts counts_;  //!< Objects created so far
+};
+
+const Ogre::String CountingSceneManager::FACTORY_TYPE_NAME = "CountingSceneManager";
+
+/** @brief Factory that registers the counting scene manager in the Ogre root */
+class CountingSceneManagerFactory : public Ogre::SceneManagerFactory {
+ public:
+  Ogre::SceneManager *createInstance(const Ogre::String &name) override { return new CountingSceneManager(name); }
+  void destroyInstance(Ogre::SceneManager *instance) override { delete instance; }
+
+ protected:
+  void initMetaData() const override {
+    mMetaData.typeName = CountingSceneManager::FACTORY_TYPE_NAME;
+    mMetaData.description = "Scene manager that counts the created scene nodes and movable objects";
+    mMetaData.sceneTypeMask = Ogre::ST_GENERIC;
+    mMetaData.worldGeometrySupported = false;
+  }
+};
+
+/**
+ * @class StateScene
+ * @brief Visuals of the whole-body state display, updated as the display does with its default properties
+ * The robot model is not included since it requires a URDF.
+ */
+class StateScene {
+ public:
+  StateScene(Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent_node)
+      : scene_manager_(scene_manager), parent_node_(parent_node) {
+    grf_visual_.initialize(scene_manager, parent_node);
+    cones_visual_.initialize(scene_manager, parent_node);
+    cop_visual_.initialize(scene_manager, parent_node);
+  }
+
+  /** @brief Destroy all the visuals, as the displays did before the visuals were pooled */
+  void reset() {
+    com_visual_.reset();
+    comd_visual_.reset();
+    zmp_visual_.reset();
+    icp_visual_.reset();
+    cmp_visual_.reset();
+    support_visual_.reset();
+    grf_visual_.clear();
+    cones_visual_.clear();
+    cop_visual_.clear();
+  }
+
+  /** @brief Update the visuals from a processed snapshot */
+  void apply(const WholeBodyStateSnapshot &snapshot) {
+    if (!com_visual_) {
+      com_visual_.reset(new PointVisual(scene_manager_, parent_node_));
+      comd_visual_.reset(new ArrowVisual(scene_manager_, parent_node_));
+      zmp_visual_.reset(new PointVisual(scene_manager_, parent_node_));
+      icp_visual_.reset(new PointVisual(scene_manager_, parent_node_));
+      cmp_visual_.reset(new PointVisual(scene_manager_, parent_node_));
+      support_visual_.reset(new PolygonVisual(scene_manager_, parent_node_));
+      com_visual_->setColor(1., 0.333, 0., 1.);
+      com_visual_->setRadius(0.04);
+      comd_visual_->setColor(1., 0.333, 0., 1.);
+      zmp_visual_->setColor(0., 1., 0.498, 1.);
+      zmp_visual_->setRadius(0.04);
+      icp_visual_->setColor(0.039, 0.039, 1., 1.);
+      icp_visual_->setRadius(0.04);
+      cmp_visual_->setColor(0.784, 0.078, 0.078, 1.);
+      cmp_visual_->setRadius(0.04);
+      support_visual_->setLineColor(0.784, 0.784, 0.784, 1.);
+      support_visual_->setMeshColor(0.039, 0.784, 0.039, 0.2);
+      support_visual_->setLineRadius(0.005);
+    }
+    // The visuals are expressed in the message frame, so only their parent node is posed
+    parent_node_->setPosition(Ogre::Vector3::ZERO);
+    parent_node_->setOrientation(Ogre::Quaternion::IDENTITY);
+
+    const std::size_t num_contacts = snapshot.contacts.size();
+    if (grf_visual_.resize(num_contacts)) {
+      for (std::size_t i = 0; i < num_contacts; ++i) {
+        grf_visual_[i]->setColor(0.784, 0.333, 0.4, 1.);
+      }
+    }
+    if (cones_visual_.resize(num_contacts)) {
+      for (std::size_t i = 0; i < num_contacts; ++i) {
+        cones_visual_[i]->setColor(1., 0.333, 0., 0.5);
+      }
+    }
+    if (cop_visual_.resize(num_contacts)) {
+      for (std::size_t i = 0; i < num_contacts; ++i) {
+        cop_visual_[i]->setColor(0.784, 0.078, 0.078, 1.);
+        cop_visual_[i]->setRadius(0.04);
+      }
+    }
+    for (std::size_t i = 0; i < num_contacts; ++i) {
+      const ContactSnapshot &contact = snapshot.contacts[i];
+      const Ogre::Vector3 contact_pos(contact.position(0), contact.position(1), contact.position(2));
+      const Ogre::Quaternion contact_orientation(contact.orientation.w(), contact.orientation.x(),
+                                                 contact.orientation.y(), contact.orientation.z());
+      cop_visual_[i]->setPoint(Ogre::Vector3(contact.cop(0), contact.cop(1), contact.cop(2)));
+      cop_visual_[i]->setFramePosition(contact_pos);
+      cop_visual_[i]->setFrameOrientation(contact_orientation);
+      cop_visual_[i]->setVisible(contact.cop_visible);
+
+      const Ogre::Quaternion force_orientation(contact.force_orientation.w(), contact.force_orientation.x(),
+                                               contact.force_orientation.y(), contact.force_orientation.z());
+      grf_visual_[i]->setArrow(contact_pos, force_orientation);
+      grf_visual_[i]->setProperties(0.8 * contact.force_ratio, 0.02, 0.08, 0.04);
+      grf_visual_[i]->setVisible(contact.grf_visible);
+
+      const Ogre::Quaternion cone_orientation(contact.cone_orientation.w(), contact.cone_orientation.x(),
+                                              contact.cone_orientation.y(), contact.cone_orientation.z());
+      cones_visual_[i]->setCone(contact_pos, cone_orientation);
+      cones_visual_[i]->setProperties(2. * 0.2 * std::tan(contact.friction_mu / std::sqrt(2.)), 0.2);
+      cones_visual_[i]->setVisible(contact.cone_visible);
+    }
+
+    const Ogre::Vector3 com_point(snapshot.com(0), snapshot.com(1), snapshot.com(2));
+    const Ogre::Quaternion comd_orientation(snapshot.com_velocity_orientation.w(),
+                                            snapshot.com_velocity_orientation.x(),
+                                            snapshot.com_velocity_orientation.y(),
+                                            snapshot.com_velocity_orientation.z());
+    com_visual_->setPoint(com_point);
+    comd_visual_->setProperties(0.4 * snapshot.com_velocity.norm(), 0.02, 0.08, 0.04);
+    comd_visual_->setArrow(com_point, comd_orientation);
+
+    zmp_visual_->setPoint(Ogre::Vector3(snapshot.zmp(0), snapshot.zmp(1), snapshot.zmp(2)));
+    icp_visual_->setPoint(Ogre::Vector3(snapshot.icp(0), snapshot.icp(1), snapshot.icp(2)));
+    cmp_visual_->setPoint(Ogre::Vector3(snapshot.cmp(0), snapshot.cmp(1), snapshot.cmp(2)));
+
+    support_.clear();
+    for (std::size_t i = 0; i < snapshot.support.size(); ++i) {
+      const Eigen::Vector3d &vertex = snapshot.support[i];
+      support_.push_back(Ogre::Vector3(vertex(0), vertex(1), vertex(2)));
+    }
+    support_visual_->setVertices(support_);
+  }
+
+ private:
+  Ogre::SceneManager *scene_manager_;
+  Ogre::SceneNode *parent_node_;
+  boost::shared_ptr<PointVisual> com_visual_;
+  boost::shared_ptr<ArrowVisual> comd_visual_;
+  boost::shared_ptr<PointVisual> zmp_visual_;
+  boost::shared_ptr<PointVisual> icp_visual_;
+  boost::shared_ptr<PointVisual> cmp_visual_;
+  boost::shared_ptr<PolygonVisual> support_visual_;
+  VisualPool<ArrowVisual> grf_visual_;
+  VisualPool<ConeVisual> cones_visual_;
+  VisualPool<PointVisual> cop_visual_;
+  std::vector<Ogre::Vector3> support_;
+};
+
+/**
+ * @class TrajectoryScene
+ * @brief Visuals of the whole-body trajectory display, updated as the display does with its default properties
+ * The CoM and every contact series are drawn as billboard lines with axes at the knots, and the contact forces of the
+ * target posture as arrows. The robot model is not included since it requires a URDF.
+ */
+class TrajectoryScene {
+ public:
+  TrajectoryScene(Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent_node)
+      : scene_manager_(scene_manager), parent_node_(parent_node) {
+    force_visual_.initialize(scene_manager, parent_node);
+  }
+
+  /** @brief Destroy all the visuals, as the displays did before the visuals were pooled */
+  void reset() {
+    series_.clear();
+    force_visual_.clear();
+  }
+
+  /** @brief Update the visuals from a trajectory message */
+  void apply(const whole_body_state_msgs::WholeBodyTrajectory &msg) {
+    // Sampling the CoM series and one series per contact name
+    sampleCoMTrajectory(msg.trajectory, Eigen::Vector3d::Zero(), Eigen::Quaterniond::Identity(), com_knots_);
+    sampleContactTrajectories(msg.trajectory, Eigen::Vector3d::Zero(), Eigen::Quaterniond::Identity(), contact_knots_);
+
+    // Drawing the series
+    series_.resize(1 + contact_knots_.size());
+    for (std::size_t i = 0; i < series_.size(); ++i) {
+      Series &series = series_[i];
+      const TrajectorySeries &knots = i == 0 ? com_knots_ : contact_knots_[i - 1];
+      const std::vector<Eigen::Vector3d> &positions = knots.positions;
+      if (!series.line) {
+        series.line.reset(new rviz::BillboardLine(scene_manager_, parent_node_));
+        series.line->setNumLines(1);
+        series.axes.reset(new AxesListVisual(scene_manager_, parent_node_));
+      }
+      if (positions.size() > series.capacity) {
+        series.line->setMaxPointsPerLine(positions.size());
+        series.capacity = positions.size();
+      }
+      series.line->clear();
+      series.line->setLineWidth(0.01);
+      const Ogre::ColourValue color(0., 0.498, 1., 1.);
+      for (std::size_t j = 0; j < positions.size(); ++j) {
+        series.line->addPoint(Ogre::Vector3(positions[j].x(), positions[j].y(), positions[j].z()), color);
+      }
+      series.axes->setLength(0.04);
+      series.axes->setAxes(knots);
+    }
+
+    // Drawing the contact forces of the target posture
+    if (msg.trajectory.empty()) {
+      force_visual_.resize(0);
+      return;
+    }
+    const whole_body_state_msgs::WholeBodyState &target = msg.trajectory.back();
+    if (force_visual_.resize(target.contacts.size())) {
+      for (std::size_t i = 0; i < force_visual_.size(); ++i) {
+        force_visual_[i]->setColor(0.784, 0.333, 0.4, 1.);
+      }
+    }
+    for (std::size_t i = 0; i < target.contacts.size(); ++i) {
+      const whole_body_state_msgs::ContactState &contact = target.contacts[i];
+      const Eigen::Vector3d force(contact.wrench.force.x, contact.wrench.force.y, contact.wrench.force.z);
+      const Eigen::Quaterniond force_orientation =
+          Eigen::Quaterniond::FromTwoVectors(-Eigen::Vector3d::UnitZ(), force);
+      const Ogre::Vector3 contact_pos(contact.pose.position.x, contact.pose.position.y, contact.pose.position.z);
+      force_visual_[i]->setArrow(contact_pos, Ogre::Quaternion(force_orientation.w(), force_orientation.x(),
+                                                               force_orientation.y(), force_orientation.z()));
+      force_visual_[i]->setProperties(0.8 * force.norm() / 500., 0.02, 0.08, 0.04);
+    }
+  }
+
+ private:
+  /** @brief Geometry of a series */
+  struct Series {
+    Series() : capacity(0) {}
+
+    boost::shared_ptr<rviz::BillboardLine> line;
+    std::size_t capacity;
+    boost::shared_ptr<AxesListVisual> axes;
+  };
+
+  Ogre::SceneManager *scene_manager_;
+  Ogre::SceneNode *parent_node_;
+  TrajectorySeries com_knots_;
+  std::vector<TrajectorySeries> contact_knots_;
+  std::vector<Series> series_;
+  VisualPool<ArrowVisual> force_visual_;
+};
+
+/** @brief Creation counts and wall time of the visual updates of a replayed message */
+struct MessageSample {
+  CreationCounts counts;  //!< Objects created by the message
+  double wall_time;       //!< Wall time of the visual updates in seconds
+};
+
+/** @brief Print the creations of the first message, the mean creations of the others, and the wall times */
+void report(const char *display, const std::vector<MessageSample> &samples) {
+  if (samples.empty()) {
+    return;
+  }
+  CreationCounts steady;
+  std::vector<double> wall_times;
+  for (std::size_t i = 0; i < samples.size(); ++i) {
+    if (i > 0) {
+      steady.scene_nodes += samples[i].counts.scene_nodes;
+      steady.entities += samples[i].counts.entities;
+      steady.manual_objects += samples[i].counts.manual_objects;
+      steady.other_objects += samples[i].counts.other_objects;
+    }
+    wall_times.push_back(samples[i].wall_time);
+  }
+  const double num_steady = std::max<std::size_t>(samples.size() - 1, 1);
+  double mean = 0.;
+  for (std::size_t i = 0; i < wall_times.size(); ++i) {
+    mean += wall_times[i];
+  }
+  mean /= wall_times.size();
+  const std::size_t p95_index = (95 * (wall_times.size() - 1)) / 100;
+  std::nth_element(wall_times.begin(), wall_times.begin() + p95_index, wall_times.end());
+  const double p95 = wall_times[p95_index];
+  const double max = *std::max_element(wall_times.begin(), wall_times.end());
+
+  const CreationCounts &first = samples.front().counts;
+  std::printf("%-12s %8zu %7zu/%-9.2f %7zu/%-9.2f %7zu/%-9.2f %7zu/%-9.2f %8.3f/%.3f/%.3f\n", display, samples.size(),
+              first.scene_nodes, steady.scene_nodes / num_steady, first.entities, steady.entities / num_steady,
+              first.manual_objects, steady.manual_objects / num_steady, first.other_objects,
+              steady.other_objects / num_steady, 1e3 * mean, 1e3 * p95, 1e3 * max);
+}
+
+void printUsage(const char *name) {
+  std::printf(
+      "Usage: %s [--messages N] [--joints N] [--contacts N] [--horizon N] [--recreate]\n"
+      "  --messages  Number of replayed messages per display (default 500)\n"
+      "  --joints    Number of joints of the synthetic robot (default 30)\n"
+      "  --contacts  Number of contacts per message (default 4)\n"
+      "  --horizon   Number of knots per trajectory message (default 100)\n"
+      "  --recreate  Destroy all the visuals before each message, i.e. no pooling\n",
+      name);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  std::size_t num_messages = 500, num_joints = 30, num_contacts = 4, horizon = 100;
+  bool recreate = false;
+  for (int i = 1; i < argc; ++i) {
+    const bool has_value = i + 1 < argc;
+    if (std::strcmp(argv[i], "--messages") == 0 && has_value) {
+      num_messages = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--joints") == 0 && has_value) {
+      num_joints = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--contacts") == 0 && has_value) {
+      num_contacts = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--horizon") == 0 && has_value) {
+      horizon = std::strtoul(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--recreate") == 0) {
+      recreate = true;
+    } else {
+      printUsage(argv[0]);
+      return std::strcmp(argv[i], "--help") == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  }
+
+  // Starting Ogre and creating the counting scene manager
+  Ogre::Root *root = rviz::RenderSystem::get()->root();
+  Ogre::ResourceGroupManager::getSingleton().initialiseAllResourceGroups();
+  CountingSceneManagerFactory factory;
+  root->addSceneManagerFactory(&factory);
+  CountingSceneManager *scene_manager =
+      static_cast<CountingSceneManager *>(root->createSceneManager(CountingSceneManager::FACTORY_TYPE_NAME));
+
+  // Generating the messages before replaying them, so that only the visual updates are timed
+  boost::shared_ptr<pinocchio::Model> model = boost::make_shared<pinocchio::Model>();
+  synthetic::buildSyntheticModel(num_joints, *model);
+  WholeBodyStateProcessor processor;
+  processor.setModel(model);
+  ProcessingParameters params;
+  params.robot_enable = false;
+  std::vector<WholeBodyStateSnapshot> snapshots(num_messages);
+  std::vector<whole_body_state_msgs::WholeBodyTrajectory> trajectories(num_messages);
+  for (std::size_t i = 0; i < num_messages; ++i) {
+    whole_body_state_msgs::WholeBodyState msg;
+    synthetic::buildSyntheticState(num_joints, num_contacts, 0.02 * i, msg);
+    processor.process(msg, params, snapshots[i]);
+    whole_body_state_msgs::WholeBodyTrajectory &trajectory = trajectories[i];
+    trajectory.header.frame_id = "odom";
+    trajectory.trajectory.resize(horizon);
+    for (std::size_t j = 0; j < horizon; ++j) {
+      synthetic::buildSyntheticState(num_joints, num_contacts, 0.02 * (i + j), trajectory.trajectory[j]);
+    }
+  }
+
+  std::printf("Visual updates per message with %zu contacts and %zu knots%s\n", num_contacts, horizon,
+              recreate ? ", recreating all the visuals" : "");
+  std::printf("%-12s %8s %17s %17s %17s %17s %s\n", "display", "messages", "nodes first/mean", "entities",
+              "manual obj", "other obj", "wall mean/p95/max [ms]");
+
+  // Replaying the messages through each scene
+  std::vector<MessageSample> samples(num_messages);
+  {
+    Ogre::SceneNode *node = scene_manager->getRootSceneNode()->createChildSceneNode();
+    StateScene scene(scene_manager, node);
+    for (std::size_t i = 0; i < num_messages; ++i) {
+      const CreationCounts counts = scene_manager->getCounts();
+      const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+      if (recreate) {
+        scene.reset();
+      }
+      scene.apply(snapshots[i]);
+      const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start_time;
+      samples[i].counts = scene_manager->getCounts() - counts;
+      samples[i].wall_time = duration.count();
+    }
+    report("state", samples);
+  }
+  {
+    Ogre::SceneNode *node = scene_manager->getRootSceneNode()->createChildSceneNode();
+    TrajectoryScene scene(scene_manager, node);
+    for (std::size_t i = 0; i < num_messages; ++i) {
+      const CreationCounts counts = scene_manager->getCounts();
+      const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+      if (recreate) {
+        scene.reset();
+      }
+      scene.apply(trajectories[i]);
+      const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start_time;
+      samples[i].counts = scene_manager->getCounts() - counts;
+      samples[i].wall_time = duration.count();
+    }
+    report("trajectory", samples);
+  }
+
+  root->destroySceneManager(scene_manager);
+  root->removeSceneManagerFactory(&factory);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_BENCHMARK_SYNTHETIC_MESSAGES_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_BENCHMARK_SYNTHETIC_MESSAGES_H
+
+#include <pinocchio/multibody/model.hpp>
+#include <whole_body_state_msgs/WholeBodyState.h>
+#include <whole_body_state_msgs/WholeBodyTrajectory.h>
+#include <cmath>
+#include <string>
+
+namespace whole_body_state_rviz_plugin {
+namespace synthetic {
+
+/** @brief Number of kinematic chains attached to the floating base of the synthetic robot */
+const std::size_t kNumLimbs = 4;
+
+/**
+ * @brief Build a synthetic robot with a free-flyer root joint
+ * The revolute joints are distributed among kNumLimbs chains attached to the base, and each joint carries a link
+ * with a random inertia.
+ * @param num_joints  Number of revolute joints
+ * @param model       Pinocchio model
+ */
+inline void buildSyntheticModel(std::size_t num_joints, pinocchio::Model &model) {
+  model = pinocchio::Model();
+  const pinocchio::JointIndex root_id =
+      model.addJoint(0, pinocchio::JointModelFreeFlyer(), pinocchio::SE3::Identity(), "root_joint");
+  model.appendBodyToJoint(root_id, pinocchio::Inertia::Random(), pinocchio::SE3::Identity());
+  model.addJointFrame(root_id);
+  model.addBodyFrame("base_link", root_id);
+
+  std::vector<pinocchio::JointIndex> limb_tips(kNumLimbs, root_id);
+  for (std::size_t i = 0; i < num_joints; ++i) {
+    const std::size_t limb = i % kNumLimbs;
+    const std::string name = "joint_" + std::to_string(i);
+    pinocchio::SE3 placement = pinocchio::SE3::Identity();
+    placement.translation() << (limb < 2 ? 0.2 : -0.2), (limb % 2 == 0 ? 0.1 : -0.1), -0.1;
+    pinocchio::JointIndex joint_id;
+    switch (i % 3) {
+      case 0:
+        joint_id = model.addJoint(limb_tips[limb], pinocchio::JointModelRX(), placement, name);
+        break;
+      case 1:
+        joint_id = model.addJoint(limb_tips[limb], pinocchio::JointModelRY(), placement, name);
+        break;
+      default:
+        joint_id = model.addJoint(limb_tips[limb], pinocchio::JointModelRZ(), placement, name);
+        break;
+    }
+    model.appendBodyToJoint(joint_id, pinocchio::Inertia::Random(), pinocchio::SE3::Identity());
+    model.addJointFrame(joint_id);
+    model.addBodyFrame("link_" + std::to_string(i), joint_id);
+    limb_tips[limb] = joint_id;
+  }
+}
+
+/**
+ * @brief Build a synthetic whole-body state of the synthetic robot
+ * The contacts are active locomotion contacts distributed around the base, and loaded with surface wrenches.
+ * @param num_joints    Number of revolute joints
+ * @param num_contacts  Number of contacts
+ * @param phase         Phase of the sinusoidal joint motion and contact loading
+ * @param state         Whole-body state
+ */
+inline void buildSyntheticState(std::size_t num_joints, std::size_t num_contacts, double phase,
+                                whole_body_state_msgs::WholeBodyState &state) {
+  state.header.frame_id = "odom";
+  state.centroidal.com_position.x = 0.1 * std::sin(phase);
+  state.centroidal.com_position.y = 0.05 * std::cos(phase);
+  state.centroidal.com_position.z = 0.8;
+  state.centroidal.com_velocity.x = 0.1 * std::cos(phase);
+  state.centroidal.com_velocity.y = -0.05 * std::sin(phase);
+  state.centroidal.com_velocity.z = 0.;
+  state.centroidal.base_orientation.x = 0.;
+  state.centroidal.base_orientation.y = 0.;
+  state.centroidal.base_orientation.z = std::sin(0.05 * phase);
+  state.centroidal.base_orientation.w = std::cos(0.05 * phase);
+
+  state.joints.resize(num_joints);
+  for (std::size_t i = 0; i < num_joints; ++i) {
+    whole_body_state_msgs::JointState &joint = state.joints[i];
+    joint.name = "joint_" + std::to_string(i);
+    joint.position = 0.5 * std::sin(phase + 0.1 * i);
+    joint.velocity = 0.5 * std::cos(phase + 0.1 * i);
+    joint.effort = 0.;
+  }
+
+  state.contacts.resize(num_contacts);
+  for (std::size_t i = 0; i < num_contacts; ++i) {
+    whole_body_state_msgs::ContactState &contact = state.contacts[i];
+    const double angle = 2. * M_PI * i / num_contacts;
+    contact.name = "contact_" + std::to_string(i);
+    contact.type = contact.LOCOMOTION;
+    contact.status = contact.ACTIVE;
+    contact.pose.position.x = 0.3 * std::cos(angle) + 0.01 * std::sin(phase);
+    contact.pose.position.y = 0.2 * std::sin(angle);
+    contact.pose.position.z = 0.;
+    contact.pose.orientation.x = 0.;
+    contact.pose.orientation.y = 0.;
+    contact.pose.orientation.z = 0.;
+    contact.pose.orientation.w = 1.;
+    contact.wrench.force.x = 5. * std::sin(phase + angle);
+    contact.wrench.force.y = 5. * std::cos(phase + angle);
+    contact.wrench.force.z = 100. + 20. * std::sin(phase + angle);
+    contact.wrench.torque.x = 2. * std::sin(phase);
+    contact.wrench.torque.y = 2. * std::cos(phase);
+    contact.wrench.torque.z = 0.;
+    contact.surface_normal.x = 0.;
+    contact.surface_normal.y = 0.;
+    contact.surface_normal.z = 1.;
+    contact.friction_coefficient = 0.7;
+  }
+}
+
+/**
+ * @brief Build a synthetic whole-body trajectory of the synthetic robot
+ * @param num_joints    Number of revolute joints
+ * @param num_contacts  Number of contacts
+ * @param horizon       Number of knots
+ * @param trajectory    Whole-body trajectory
+ */
+inline void buildSyntheticTrajectory(std::size_t num_joints, std::size_t num_contacts, std::size_t horizon,
+                                     whole_body_state_msgs::WholeBodyTrajectory &trajectory) {
+  trajectory.header.frame_id = "odom";
+  trajectory.trajectory.resize(horizon);
+  for (std::size_t i = 0; i < horizon; ++i) {
+    buildSyntheticState(num_joints, num_contacts, 0.02 * i, trajectory.trajectory[i]);
+  }
+  buildSyntheticState(num_joints, num_contacts, 0., trajectory.actual);
+}
+
+}  // namespace synthetic
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_BENCHMARK_SYNTHETIC_MESSAGES_H
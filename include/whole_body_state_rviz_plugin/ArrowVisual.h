@@ -77,6 +77,12 @@ class ArrowVisual {
    */
   void setProperties(float shaft_length, float shaft_diameter, float head_length, float head_diameter);
 
+  /**
+   * @brief Show or hide the visual
+   * @param visible  Visibility flag
+   */
+  void setVisible(bool visible);
+
  private:
   /** @brief The object implementing the arrow */
   rviz::Arrow *arrow_;
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_AXES_LIST_VISUAL_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_AXES_LIST_VISUAL_H
+
+#include <OgreMaterial.h>
+
+#include "whole_body_state_rviz_plugin/TrajectorySeries.h"
+
+namespace Ogre {
+class ManualObject;
+}  // namespace Ogre
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @class AxesListVisual
+ * @brief Visualizes a list of coordinate frames
+ * Each frame is drawn as a triad of red, green and blue segments. All the triads are batched into a single line list,
+ * so it costs one scene node and one draw call regardless of the number of frames.
+ */
+class AxesListVisual {
+ public:
+  /**
+   * @brief Constructor that creates the visual stuff and puts it into the scene
+   * @param scene_manager  Manager the organization and rendering of the scene
+   * @param parent_node    Represent the frames as node in the scene
+   */
+  AxesListVisual(Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent_node);
+
+  /** @brief Destructor that removes the visual stuff from the scene */
+  ~AxesListVisual();
+
+  /**
+   * @brief Configure the visual to show the frames
+   * @param axes  Frame positions and orientations
+   */
+  void setAxes(const TrajectorySeries &axes);
+
+  /**
+   * @brief Set the length of the triad segments
+   * @param length  Segment length
+   */
+  void setLength(float length);
+
+  /**
+   * @brief Set the alpha of the triads, which is user-editable
+   * @param alpha  Alpha value
+   */
+  void setAlpha(float alpha);
+
+  /**
+   * @brief Show or hide the visual
+   * @param visible  Visibility flag
+   */
+  void setVisible(bool visible);
+
+  /** @brief Return the number of frames */
+  std::size_t size() const;
+
+ private:
+  /** @brief Write the triads of the frames into the line list */
+  void updateMesh();
+
+  /** @brief The object implementing the batched triads */
+  Ogre::ManualObject *mesh_;
+
+  /** @brief The material of the batched triads */
+  Ogre::MaterialPtr material_;
+
+  /** @brief Whether the mesh section has been created, and then it can be updated in place */
+  bool mesh_initialized_;
+
+  /** @brief Frame positions and orientations */
+  TrajectorySeries axes_;
+
+  /** @brief Vertices of the triads, which are computed outside of Ogre */
+  Eigen::Matrix3Xd vertices_;
+
+  /** @brief Length of the triad segments */
+  float length_;
+
+  /** @brief Alpha of the triads */
+  float alpha_;
+
+  /** @brief A SceneNode whose pose is set to match the coordinate frame */
+  Ogre::SceneNode *frame_node_;
+
+  /** @brief The SceneManager, kept here only so the destructor can ask it to
+   * destroy the ``frame_node_``.
+   */
+  Ogre::SceneManager *scene_manager_;
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_AXES_LIST_VISUAL_H
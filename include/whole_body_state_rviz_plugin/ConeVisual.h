@@ -75,6 +75,18 @@ class ConeVisual {
    */
   void setProperties(float width, float length);
 
+  /**
+   * @brief Draw the cone as a wireframe, which is cheaper to fill
+   * @param wireframe  Wireframe flag
+   */
+  void setWireframe(bool wireframe);
+
+  /**
+   * @brief Show or hide the visual
+   * @param visible  Visibility flag
+   */
+  void setVisible(bool visible);
+
  private:
   /** @brief The object implementing the cone */
   rviz::Shape *cone_;
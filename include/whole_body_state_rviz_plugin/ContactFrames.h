@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_CONTACT_FRAMES_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_CONTACT_FRAMES_H
+
+#include <Eigen/Dense>
+#include <whole_body_state_msgs/ContactState.h>
+#include <vector>
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @brief Structure-of-arrays buffer of the contacts of a whole-body state
+ * Each column stores the quantity of one contact. The buffer is filled once per message, and its memory is reused by
+ * the following messages with the same number of contacts.
+ */
+struct ContactFrames {
+  /** @brief Status bits of a contact */
+  enum Status { ACTIVE = 1 << 0, LOCOMOTION = 1 << 1 };
+
+  /**
+   * @brief Fill the buffer from the contacts of a message
+   * @param contacts  Contact states
+   */
+  void fill(const std::vector<whole_body_state_msgs::ContactState> &contacts);
+
+  /** @brief Return the number of contacts */
+  std::size_t size() const { return static_cast<std::size_t>(positions.cols()); }
+
+  Eigen::Matrix3Xd positions;             //!< Contact positions
+  Eigen::Matrix3Xd normals;               //!< Contact surface normals
+  Eigen::Matrix3Xd forces;                //!< Contact forces
+  Eigen::Matrix3Xd torques;               //!< Contact torques
+  Eigen::VectorXd friction_coefficients;  //!< Friction coefficients
+  std::vector<unsigned char> status;      //!< Status bits
+};
+
+/**
+ * @brief Compute the rotations that map a reference vector onto each direction
+ * It runs the same computation as Eigen::Quaterniond::setFromTwoVectors, but over all the columns at once.
+ * @param reference    Reference vector
+ * @param directions   Target directions
+ * @param quaternions  Rotations stored as (x, y, z, w) columns, i.e., the coefficient order of Eigen::Quaterniond
+ */
+void computeRotationsFromTwoVectors(const Eigen::Vector3d &reference, const Eigen::Matrix3Xd &directions,
+                                    Eigen::Matrix4Xd &quaternions);
+
+/**
+ * @brief Compute the centers of pressure of the contacts
+ * They are expressed in the contact frame, and they are not finite if the normal force is zero.
+ * @param forces   Contact forces
+ * @param torques  Contact torques
+ * @param cops     Centers of pressure
+ */
+void computeCentersOfPressure(const Eigen::Matrix3Xd &forces, const Eigen::Matrix3Xd &torques, Eigen::Matrix3Xd &cops);
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_CONTACT_FRAMES_H
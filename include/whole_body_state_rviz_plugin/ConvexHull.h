@@ -0,0 +1,28 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_CONVEX_HULL_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_CONVEX_HULL_H
+
+#include <Eigen/Dense>
+#include <vector>
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @brief Compute the convex hull of a set of points projected onto the ground
+ * It runs the monotone chain algorithm, i.e., O(n log n), over the xy coordinates of the points. Collinear and
+ * duplicated points are not included in the hull.
+ * @param points  Points projected onto the ground
+ * @param hull    Indices of the hull vertices in counter-clockwise order
+ */
+void computeConvexHull(const std::vector<Eigen::Vector2d> &points, std::vector<std::size_t> &hull);
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_CONVEX_HULL_H
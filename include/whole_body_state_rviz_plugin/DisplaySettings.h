@@ -0,0 +1,36 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_DISPLAY_SETTINGS_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_DISPLAY_SETTINGS_H
+
+#include <OgreColourValue.h>
+
+namespace whole_body_state_rviz_plugin {
+
+/** @brief Appearance of a point visual, as set in the display properties */
+struct PointSettings {
+  PointSettings() : radius(0.) {}
+
+  Ogre::ColourValue color;  //!< Color and alpha of the point
+  float radius;             //!< Radius of the point
+};
+
+/** @brief Geometry of an arrow visual, as set in the display properties */
+struct ArrowSettings {
+  ArrowSettings() : shaft_length(0.), shaft_radius(0.), head_length(0.), head_radius(0.) {}
+
+  float shaft_length;  //!< Length of the shaft, which is scaled by the displayed quantity
+  float shaft_radius;  //!< Radius of the shaft
+  float head_length;   //!< Length of the head
+  float head_radius;   //!< Radius of the head
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_DISPLAY_SETTINGS_H
@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_GHOST_VISUAL_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_GHOST_VISUAL_H
+
+#include <OgreMaterial.h>
+#include <OgreQuaternion.h>
+#include <OgreVector3.h>
+#include <vector>
+
+#include "whole_body_state_rviz_plugin/LinkFrames.h"
+
+namespace Ogre {
+class Entity;
+class SceneManager;
+class SceneNode;
+}  // namespace Ogre
+
+namespace rviz {
+class Robot;
+}  // namespace rviz
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @class GhostVisual
+ * @brief Visualizes a posture of a robot as a translucent copy of its links
+ * The copy is built once from the links of a loaded rviz::Robot. Its entities share the meshes of the robot and a
+ * single material, and they are posed from the link placements of a snapshot. Unlike a second rviz::Robot, it does
+ * not parse the description nor create any property or material per link.
+ */
+class GhostVisual {
+ public:
+  /**
+   * @brief Constructor that copies the links of a robot and puts them into the scene
+   * @param scene_manager  Manager the organization and rendering of the scene
+   * @param parent_node    Represent the ghost as node in the scene
+   * @param robot          Loaded robot whose links are copied
+   * @param link_frames    Link frames of the Pinocchio model
+   * @param material       Material shared by the entities of the ghost
+   */
+  GhostVisual(Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent_node, const rviz::Robot &robot,
+              const LinkFrames &link_frames, const Ogre::MaterialPtr &material);
+
+  /** @brief Destructor that removes the visual stuff from the scene */
+  ~GhostVisual();
+
+  /**
+   * @brief Pose the links of the ghost
+   * @param placements  Placements of the link frames, which are indexed as in LinkFrames
+   */
+  void setPosture(const LinkFrames::FramePlacements &placements);
+
+  /**
+   * @brief Set the position of the frame in which the link placements are expressed
+   * @param position  Frame position
+   */
+  void setFramePosition(const Ogre::Vector3 &position);
+
+  /**
+   * @brief Set the orientation of the frame in which the link placements are expressed
+   * @param orientation  Frame orientation
+   */
+  void setFrameOrientation(const Ogre::Quaternion &orientation);
+
+  /**
+   * @brief Show or hide the visual
+   * @param visible  Visibility flag
+   */
+  void setVisible(bool visible);
+
+  /**
+   * @brief Show or hide the visual geometry of the links
+   * @param visible  Visibility flag
+   */
+  void setVisualVisible(bool visible);
+
+  /**
+   * @brief Show or hide the collision geometry of the links
+   * @param visible  Visibility flag
+   */
+  void setCollisionVisible(bool visible);
+
+ private:
+  /**
+   * @brief Copy the nodes and entities below a node of the robot
+   * @param source  Node of the robot
+   * @param target  Node of the ghost that receives the copies
+   */
+  void copyNode(Ogre::SceneNode *source, Ogre::SceneNode *target);
+
+  /** @brief Apply the visibility flags to the visual and collision nodes */
+  void updateVisibility();
+
+  Ogre::SceneManager *scene_manager_;      //!< Manager used to destroy the entities and nodes
+  Ogre::SceneNode *frame_node_;            //!< Node of the ghost
+  Ogre::SceneNode *visual_node_;           //!< Parent node of the visual geometry
+  Ogre::SceneNode *collision_node_;        //!< Parent node of the collision geometry
+  Ogre::MaterialPtr material_;             //!< Material shared by the entities
+  std::vector<Ogre::SceneNode *> links_;   //!< Node of each copied link
+  std::vector<std::size_t> link_indices_;  //!< Index of each copied link in the placements
+  std::vector<Ogre::SceneNode *> nodes_;   //!< Nodes created below the links, in creation order
+  std::vector<Ogre::Entity *> entities_;   //!< Entities that share the meshes of the robot
+  bool visible_;                           //!< Whether the ghost is displayed
+  bool visual_visible_;                    //!< Whether the visual geometry is displayed
+  bool collision_visible_;                 //!< Whether the collision geometry is displayed
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_GHOST_VISUAL_H
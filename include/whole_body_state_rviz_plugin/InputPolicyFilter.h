@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_INPUT_POLICY_FILTER_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_INPUT_POLICY_FILTER_H
+
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <message_filters/simple_filter.h>
+#include <ros/time.h>
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @class InputPolicyFilter
+ * @brief Message filter that decimates an input stream before any further filtering
+ * It sits between the topic subscriber and the TF filter of a display, so the dropped messages are never TF-filtered.
+ * The policies are:
+ *  - ALL forwards every message,
+ *  - LATEST_ONLY holds the latest message until flush() is called, typically once per render frame,
+ *  - MAX_RATE forwards a message only if the previous one was forwarded long enough ago,
+ *  - KEEP_EVERY_NTH forwards one message out of every N.
+ */
+template <class M>
+class InputPolicyFilter : public message_filters::SimpleFilter<M> {
+ public:
+  typedef message_filters::MessageEvent<M const> EventType;
+
+  enum Policy { ALL, LATEST_ONLY, MAX_RATE, KEEP_EVERY_NTH };
+
+  /** @brief Constructor function */
+  InputPolicyFilter()
+      : policy_(ALL),
+        max_rate_(30.),
+        keep_every_(1),
+        has_pending_(false),
+        skipped_(0),
+        received_(0),
+        dropped_(0),
+        forwarded_(0) {}
+
+  /** @brief Destructor function */
+  ~InputPolicyFilter() { incoming_connection_.disconnect(); }
+
+  /**
+   * @brief Connect the filter to its input
+   * @param f  Input filter or subscriber
+   */
+  template <class F>
+  void connectInput(F &f) {
+    incoming_connection_.disconnect();
+    incoming_connection_ = f.registerCallback(
+        typename message_filters::SimpleFilter<M>::EventCallback(boost::bind(&InputPolicyFilter::add, this, _1)));
+  }
+
+  /**
+   * @brief Set the decimation policy
+   * A message held by the latest-only policy is dropped when the policy changes.
+   * @param policy      Decimation policy
+   * @param max_rate    Maximum forwarding rate in Hz, used by MAX_RATE
+   * @param keep_every  Number N of received messages per forwarded one, used by KEEP_EVERY_NTH
+   */
+  void setPolicy(Policy policy, double max_rate, unsigned int keep_every) {
+    boost::mutex::scoped_lock lock(mutex_);
+    if (policy != policy_ && has_pending_) {
+      has_pending_ = false;
+      pending_ = EventType();
+      ++dropped_;
+    }
+    policy_ = policy;
+    max_rate_ = max_rate;
+    keep_every_ = keep_every > 0 ? keep_every : 1;
+  }
+
+  /** @brief Forward the message held by the latest-only policy */
+  void flush() {
+    EventType event;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      if (!has_pending_) {
+        return;
+      }
+      event = pending_;
+      pending_ = EventType();
+      has_pending_ = false;
+      ++forwarded_;
+    }
+    this->signalMessage(event);
+  }
+
+  /** @brief Drop the held message and reset the counters */
+  void clear() {
+    boost::mutex::scoped_lock lock(mutex_);
+    pending_ = EventType();
+    has_pending_ = false;
+    skipped_ = 0;
+    received_ = 0;
+    dropped_ = 0;
+    forwarded_ = 0;
+  }
+
+  /**@{*/
+  /** Return the number of received, dropped and forwarded messages */
+  std::size_t getReceived() const { return received_; }
+  std::size_t getDropped() const { return dropped_; }
+  std::size_t getForwarded() const { return forwarded_; }
+  /**@}*/
+
+ private:
+  /** @brief Callback of the input, which applies the policy */
+  void add(const EventType &event) {
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      ++received_;
+      switch (policy_) {
+        case ALL:
+          break;
+        case LATEST_ONLY:
+          if (has_pending_) {
+            ++dropped_;
+          }
+          pending_ = event;
+          has_pending_ = true;
+          return;
+        case MAX_RATE: {
+          const ros::WallTime now = ros::WallTime::now();
+          if (forwarded_ != 0 && max_rate_ > 0. && (now - last_forward_time_).toSec() < 1. / max_rate_) {
+            ++dropped_;
+            return;
+          }
+          last_forward_time_ = now;
+        } break;
+        case KEEP_EVERY_NTH:
+          if (skipped_ + 1 < keep_every_) {
+            ++skipped_;
+            ++dropped_;
+            return;
+          }
+          skipped_ = 0;
+          break;
+      }
+      ++forwarded_;
+    }
+    this->signalMessage(event);
+  }
+
+  message_filters::Connection incoming_connection_;  //!< Connection to the input
+  boost::mutex mutex_;                               //!< Protects the policy, the held message and the counters
+  Policy policy_;                                    //!< Decimation policy
+  double max_rate_;                                  //!< Maximum forwarding rate of the MAX_RATE policy
+  unsigned int keep_every_;                          //!< Decimation factor of the KEEP_EVERY_NTH policy
+  EventType pending_;                                //!< Message held by the LATEST_ONLY policy
+  bool has_pending_;                                 //!< Whether there is a held message
+  ros::WallTime last_forward_time_;                  //!< Time of the last message forwarded by the MAX_RATE policy
+  unsigned int skipped_;                             //!< Messages skipped since the last forwarded one
+  std::size_t received_;                             //!< Number of received messages
+  std::size_t dropped_;                              //!< Number of dropped messages
+  std::size_t forwarded_;                            //!< Number of forwarded messages
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_INPUT_POLICY_FILTER_H
@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_JOINT_CONFIGURATION_MAPPER_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_JOINT_CONFIGURATION_MAPPER_H
+
+#include <pinocchio/multibody/model.hpp>
+#include <whole_body_state_msgs/WholeBodyState.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @class JointConfigurationMapper
+ * @brief Maps the joints of a whole-body state message into a Pinocchio configuration vector
+ * The joint-name map is built once per model. Then, the q-index of each message joint is cached per message layout,
+ * i.e., per fingerprint of the joint-name sequence, which turns the decoding of the following messages into a
+ * straight indexed copy. Each layout keeps its joint names, so a fingerprint collision rebuilds the layout instead of
+ * reusing the q-indices of another sequence. As a stream keeps its joint order, the layout of the previous message is
+ * reused when the joint count and a few sampled names match, which skips the fingerprint and the name comparison.
+ */
+class JointConfigurationMapper {
+ public:
+  /** @brief Constructor function */
+  JointConfigurationMapper();
+
+  /**
+   * @brief Build the joint-name map of a model with a free-flyer root joint
+   * @param model  Pinocchio model
+   */
+  void setModel(const pinocchio::Model &model);
+
+  /** @brief Clear the joint-name map and the cached layouts */
+  void clear();
+
+  /**
+   * @brief Fill the configuration vector with the base orientation and joint positions of a whole-body state
+   * The base position is left to zero as it depends on the center of mass of the configuration.
+   * @param state  Whole-body state
+   * @param q      Configuration vector of dimension nq
+   */
+  void fillConfiguration(const whole_body_state_msgs::WholeBodyState &state, Eigen::Ref<Eigen::VectorXd> q);
+
+  /** @brief Return the number of messages decoded with a cached layout */
+  std::size_t getCacheHits() const;
+
+  /** @brief Return the number of messages that required to build a new layout */
+  std::size_t getCacheMisses() const;
+
+ private:
+  /** @brief Type of the joint w.r.t. how its position is written into the configuration vector */
+  enum JointType {
+    UNSUPPORTED,  //!< Unknown joint, or joint that cannot be defined by a single position
+    SCALAR,       //!< One-dimensional joint, e.g., revolute or prismatic
+    UNBOUNDED     //!< Unbounded revolute joint, which is described by its cosine and sine
+  };
+
+  struct JointSlot {
+    JointSlot() : idx_q(0), type(UNSUPPORTED) {}
+    JointSlot(int _idx_q, JointType _type) : idx_q(_idx_q), type(_type) {}
+
+    int idx_q;       //!< Index of the joint in the configuration vector
+    JointType type;  //!< Joint type
+  };
+
+  /** @brief Q-index layout of a joint-name sequence */
+  struct Layout {
+    std::vector<std::string> names;  //!< Joint-name sequence of the layout
+    std::vector<JointSlot> slots;    //!< Slot of each joint of the sequence
+  };
+
+  /**
+   * @brief Return the q-index layout of a joint-name sequence, building it if it is not cached
+   * @param joints  Joint states of the message
+   */
+  const std::vector<JointSlot> &getLayout(const std::vector<whole_body_state_msgs::JointState> &joints);
+
+  /** @brief Compute the fingerprint of a joint-name sequence */
+  static std::size_t computeFingerprint(const std::vector<whole_body_state_msgs::JointState> &joints);
+
+  /**
+   * @brief Return true if a joint-name sequence has the joint count of a layout and its first, middle and last names
+   * @param layout  Cached layout
+   * @param joints  Joint states of the message
+   */
+  static bool matchesSampledNames(const Layout &layout, const std::vector<whole_body_state_msgs::JointState> &joints);
+
+  std::unordered_map<std::string, JointSlot> joint_slots_;  //!< Joint-name map built once per model
+  std::unordered_map<std::size_t, Layout> layouts_;         //!< Cached layouts per fingerprint
+  const Layout *last_layout_;                               //!< Layout of the previous message, if any
+  Eigen::VectorXd q_neutral_;                               //!< Neutral configuration of the model
+  std::size_t cache_hits_;                                  //!< Number of messages with a cached layout
+  std::size_t cache_misses_;                                //!< Number of messages with a new layout
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_JOINT_CONFIGURATION_MAPPER_H
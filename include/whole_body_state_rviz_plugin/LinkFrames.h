@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_LINK_FRAMES_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_LINK_FRAMES_H
+
+#include <pinocchio/container/aligned-vector.hpp>
+#include <pinocchio/multibody/data.hpp>
+#include <pinocchio/multibody/model.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @class LinkFrames
+ * @brief Frames of a model that correspond to the URDF links drawn by rviz::Robot
+ * The link frames are resolved once per model, so the kinematics only update their placements, and the links are
+ * looked up by name through a hash map instead of a linear scan of the model frames. Joint, operational and sensor
+ * frames are never updated.
+ */
+class LinkFrames {
+ public:
+  typedef pinocchio::container::aligned_vector<pinocchio::SE3> FramePlacements;
+
+  /**
+   * @brief Resolve the link frames of a model
+   * @param model  Pinocchio model
+   */
+  void setModel(const pinocchio::Model &model);
+
+  /** @brief Clear the link frames */
+  void clear();
+
+  /** @brief Return the number of link frames */
+  std::size_t size() const { return frame_ids_.size(); }
+
+  /**
+   * @brief Return the index of a link in the placements
+   * @param link_name  Name of the URDF link
+   * @return Index of the link, or size() if the model does not have it
+   */
+  std::size_t getIndex(const std::string &link_name) const;
+
+  /**
+   * @brief Compute the placements of the link frames w.r.t. the world
+   * The joint placements must be computed beforehand, e.g., by pinocchio::forwardKinematics.
+   * @param model       Pinocchio model
+   * @param data        Pinocchio data with the joint placements
+   * @param placements  Placements of the link frames, which are indexed as in getIndex()
+   */
+  void computePlacements(const pinocchio::Model &model, pinocchio::Data &data, FramePlacements &placements) const;
+
+ private:
+  std::vector<pinocchio::FrameIndex> frame_ids_;           //!< Model frames of the links
+  std::unordered_map<std::string, std::size_t> indices_;  //!< Index of each link in the placements
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_LINK_FRAMES_H
@@ -10,18 +10,28 @@
 #define WHOLE_BODY_STATE_RVIZ_PLUGIN_PINOCCHIO_LINK_UPDATER_H
 
 #include <boost/function.hpp>
-#include <pinocchio/multibody/data.hpp>
-#include <pinocchio/multibody/model.hpp>
 #include <rviz/robot/link_updater.h>
 #include <string>
 
+#include "whole_body_state_rviz_plugin/LinkFrames.h"
+
 namespace whole_body_state_rviz_plugin {
 
 class PinocchioLinkUpdater : public rviz::LinkUpdater {
  public:
   typedef boost::function<void(rviz::StatusLevel, const std::string &, const std::string &)> StatusCallback;
 
-  PinocchioLinkUpdater(pinocchio::Model &model, pinocchio::Data &data, const Eigen::Ref<const Eigen::VectorXd> &q,
+  typedef LinkFrames::FramePlacements FramePlacements;
+
+  /**
+   * @brief Constructor function
+   * The frame placements are computed beforehand by LinkFrames::computePlacements, which allows us to compute them
+   * outside the render thread.
+   * @param link_frames       Link frames of the Pinocchio model
+   * @param frame_placements  Placements of the link frames w.r.t. the world
+   * @param status_cb         Callback to report the link status
+   */
+  PinocchioLinkUpdater(const LinkFrames &link_frames, const FramePlacements &frame_placements,
                        const StatusCallback &status_cb = StatusCallback());
 
   bool getLinkTransforms(const std::string &link_name, Ogre::Vector3 &visual_position,
@@ -31,8 +41,8 @@ class PinocchioLinkUpdater : public rviz::LinkUpdater {
   void setLinkStatus(rviz::StatusLevel level, const std::string &link_name, const std::string &text) const override;
 
  private:
-  pinocchio::Model &model_;
-  pinocchio::Data &data_;
+  const LinkFrames &link_frames_;
+  const FramePlacements &frame_placements_;
   StatusCallback status_callback_;
 };
 
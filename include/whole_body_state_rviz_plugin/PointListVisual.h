@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_POINT_LIST_VISUAL_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_POINT_LIST_VISUAL_H
+
+#include <OgreColourValue.h>
+#include <OgreMaterial.h>
+#include <OgreVector3.h>
+#include <Eigen/Dense>
+#include <vector>
+
+namespace Ogre {
+class Quaternion;
+class ManualObject;
+}  // namespace Ogre
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @class PointListVisual
+ * @brief Visualizes a list of 3d points
+ * All the points are drawn as low-poly spheres batched into a single mesh with per-vertex colors. Therefore, it costs
+ * one scene node and one draw call regardless of the number of points.
+ */
+class PointListVisual {
+ public:
+  /**
+   * @brief Constructor that creates the visual stuff and puts it into the scene
+   * @param scene_manager  Manager the organization and rendering of the scene
+   * @param parent_node    Represent the points as node in the scene
+   */
+  PointListVisual(Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent_node);
+
+  /** @brief Destructor that removes the visual stuff from the scene */
+  ~PointListVisual();
+
+  /**
+   * @brief Configure the visual to show the points
+   * @param points  Point positions
+   */
+  void setPoints(const std::vector<Eigen::Vector3d> &points);
+
+  /**
+   * @brief Set the position of the coordinate frame
+   * @param position  Frame position
+   */
+  void setFramePosition(const Ogre::Vector3 &position);
+
+  /**
+   * @brief Set the orientation of the coordinate frame
+   * @param orientation  Frame orientation
+   */
+  void setFrameOrientation(const Ogre::Quaternion &orientation);
+
+  /**
+   * @brief Set the color and alpha of all the points, which are user-editable
+   * @param r  Red value
+   * @param g  Green value
+   * @param b  Blue value
+   * @param a  Alpha value
+   */
+  void setColor(float r, float g, float b, float a);
+
+  /**
+   * @brief Set the radius of the points
+   * @param r  Radius value
+   */
+  void setRadius(float r);
+
+  /**
+   * @brief Show or hide the visual
+   * @param visible  Visibility flag
+   */
+  void setVisible(bool visible);
+
+  /** @brief Return the number of points */
+  std::size_t size() const;
+
+ private:
+  /** @brief Write the spheres of the points into the mesh */
+  void updateMesh();
+
+  /** @brief The object implementing the batched spheres */
+  Ogre::ManualObject *mesh_;
+
+  /** @brief The material of the batched spheres */
+  Ogre::MaterialPtr material_;
+
+  /** @brief Whether the mesh section has been created, and then it can be updated in place */
+  bool mesh_initialized_;
+
+  /** @brief Point positions */
+  std::vector<Eigen::Vector3d> points_;
+
+  /** @brief Color of the points */
+  Ogre::ColourValue color_;
+
+  /** @brief Radius of the points */
+  float radius_;
+
+  /** @brief A SceneNode whose pose is set to match the coordinate frame */
+  Ogre::SceneNode *frame_node_;
+
+  /** @brief The SceneManager, kept here only so the destructor can ask it to
+   * destroy the ``frame_node_``.
+   */
+  Ogre::SceneManager *scene_manager_;
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_POINT_LIST_VISUAL_H
@@ -71,6 +71,12 @@ class PointVisual {
    */
   void setRadius(float r);
 
+  /**
+   * @brief Show or hide the visual
+   * @param visible  Visibility flag
+   */
+  void setVisible(bool visible);
+
  private:
   /** @brief The object implementing the point circle */
   rviz::Shape *point_;
@@ -9,30 +9,30 @@
 #ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_POLYGON_VISUAL_H
 #define WHOLE_BODY_STATE_RVIZ_PLUGIN_POLYGON_VISUAL_H
 
-#include "whole_body_state_rviz_plugin/LineVisual.h"
-#include <rviz/ogre_helpers/mesh_shape.h>
+#include <Eigen/Dense>
+#include <OgreColourValue.h>
+#include <OgreMaterial.h>
 #include <rviz/properties/quaternion_property.h>
 
 namespace Ogre {
 class Vector3;
 class Quaternion;
+class ManualObject;
 }  // namespace Ogre
 
-namespace whole_body_state_rviz_plugin {
-
-struct Triangle {
-  Triangle(unsigned int _v1, unsigned int _v2, unsigned int _v3) : v1(_v1), v2(_v2), v3(_v3) {}
+namespace rviz {
+class BillboardLine;
+}
 
-  unsigned int v1;
-  unsigned int v2;
-  unsigned int v3;
-};
+namespace whole_body_state_rviz_plugin {
 
 /**
  * @class PolygonVisual
- * @brief Visualizes the whole set of polygons given a vector of 3d points
- * Each instance of PolygonVisual represents the visualization of a set of
- * polygons data. Currently it just shows a set of polygons
+ * @brief Visualizes the convex hull of a vector of 3d points
+ * Each instance of PolygonVisual represents the visualization of a support
+ * polygon. It is drawn with one outline and one filled mesh, which are updated
+ * in place. Therefore, it costs two draw calls regardless of the number of
+ * vertices.
  */
 class PolygonVisual {
  public:
@@ -47,7 +47,8 @@ class PolygonVisual {
   ~PolygonVisual();
 
   /**
-   * @brief Configure the visual to show the polygons
+   * @brief Configure the visual to show the convex hull of the vertices
+   * The hull is computed from the vertices projected onto the ground.
    * @param polygon  Vertices of the polygon
    */
   void setVertices(std::vector<Ogre::Vector3> &polygon);
@@ -88,12 +89,42 @@ class PolygonVisual {
    */
   void setLineRadius(float scale);
 
+  /**
+   * @brief Show or hide the visual
+   * @param visible  Visibility flag
+   */
+  void setVisible(bool visible);
+
  private:
+  /** @brief Write the hull vertices into the filled mesh */
+  void updateMesh();
+
   /** @brief The object implementing the polygon mesh */
-  boost::shared_ptr<rviz::MeshShape> mesh_;
+  Ogre::ManualObject *mesh_;
+
+  /** @brief The material of the polygon mesh */
+  Ogre::MaterialPtr mesh_material_;
+
+  /** @brief Whether the mesh section has been created, and then it can be updated in place */
+  bool mesh_initialized_;
+
+  /** @brief Color of the polygon mesh */
+  Ogre::ColourValue mesh_color_;
+
+  /** @brief The object implementing the outline */
+  rviz::BillboardLine *line_;
+
+  /** @brief Maximum number of points allocated in the outline */
+  std::size_t line_capacity_;
+
+  /** @brief Vertices of the convex hull in counter-clockwise order */
+  std::vector<Ogre::Vector3> hull_vertices_;
+
+  /** @brief Workspace with the vertices projected onto the ground */
+  std::vector<Eigen::Vector2d> projected_vertices_;
 
-  /** @brief The object implementing the lines */
-  std::vector<boost::shared_ptr<whole_body_state_rviz_plugin::LineVisual>> line_;
+  /** @brief Workspace with the indices of the hull vertices */
+  std::vector<std::size_t> hull_indices_;
 
   /** @brief A SceneNode whose pose is set to match the coordinate frame */
   Ogre::SceneNode *frame_node_;
@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_RENDER_BUDGET_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_RENDER_BUDGET_H
+
+#include <cstddef>
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @class RenderBudget
+ * @brief Selects the level of detail of the contact overlays from the frame cost of a display
+ * The cost of the frames that apply snapshots is smoothed, and the level of detail is lowered one step when it exceeds
+ * the budget. It is raised one step again when the cost falls below half of the budget, so the levels do not
+ * oscillate. The level is kept for a hold time after each change, which lets the cost settle.
+ */
+class RenderBudget {
+ public:
+  /** @brief Levels of detail, in the order in which they are degraded */
+  enum Level {
+    FULL,           //!< All the overlays are drawn
+    SIMPLE_CONES,   //!< Friction cones are drawn as wireframes
+    MERGED_FORCES,  //!< Contact forces are merged into the net contact force
+    DECIMATED,      //!< Contact overlays and the support region are only updated every other snapshot
+    NUM_LEVELS
+  };
+
+  /**
+   * @brief Constructor function
+   * @param hold_time  Time in seconds during which a level is kept after it changed
+   */
+  explicit RenderBudget(double hold_time = 1.);
+
+  /**
+   * @brief Set the frame-cost budget, which resets the level to full detail
+   * @param budget  Budget in seconds, the level of detail is not degraded if it is zero
+   */
+  void setBudget(double budget);
+
+  /** @brief Return the frame-cost budget in seconds */
+  double getBudget() const { return budget_; }
+
+  /**
+   * @brief Record the cost of a frame that applied snapshots
+   * @param cost  Cost in seconds
+   */
+  void recordCost(double cost);
+
+  /**
+   * @brief Select the level of detail, it is called once per render frame
+   * @param dt  Time elapsed since the last frame in seconds
+   * @return True if the level changed
+   */
+  bool update(double dt);
+
+  /** @brief Return the current level of detail */
+  Level getLevel() const { return level_; }
+
+  /** @brief Return the smoothed frame cost in seconds */
+  double getCost() const { return cost_; }
+
+  /** @brief Return the smoothed frame cost that caused the latest degradation, in seconds */
+  double getTriggerCost() const { return trigger_cost_; }
+
+  /** @brief Return the name of a level */
+  static const char *getLevelName(Level level);
+
+ private:
+  double budget_;        //!< Frame-cost budget, or zero if disabled
+  double hold_time_;     //!< Time during which a level is kept after it changed
+  double elapsed_;       //!< Time elapsed since the latest level change
+  double cost_;          //!< Exponentially smoothed frame cost
+  bool has_cost_;        //!< Whether a frame cost was recorded
+  double trigger_cost_;  //!< Smoothed frame cost that caused the latest degradation
+  Level level_;          //!< Current level of detail
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_RENDER_BUDGET_H
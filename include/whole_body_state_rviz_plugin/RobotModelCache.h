@@ -0,0 +1,66 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_ROBOT_MODEL_CACHE_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_ROBOT_MODEL_CACHE_H
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+#include <map>
+#include <pinocchio/multibody/model.hpp>
+#include <string>
+#include <urdf/model.h>
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @class RobotModelCache
+ * @brief Process-wide cache of the models parsed from robot descriptions
+ * The models are keyed by a hash of the URDF text, and they are shared by all the displays of the same robot. The
+ * cache only holds weak references, so a model is released once no display uses it. The cache can be accessed from
+ * any thread.
+ */
+class RobotModelCache {
+ public:
+  /** @brief Return the cache shared by all the displays */
+  static RobotModelCache &getInstance();
+
+  /**
+   * @brief Get the models of a robot description, which is only parsed when no display holds its models
+   * Each model keeps the cache entry alive, so both models can be held independently.
+   * @param description  URDF of the robot
+   * @param urdf_model   URDF model of the robot
+   * @param model        Pinocchio model of the robot with a free-flyer root joint
+   * @param error        Reason of the failure
+   * @return False if the robot description cannot be parsed
+   */
+  bool getModel(const std::string &description, boost::shared_ptr<const urdf::Model> &urdf_model,
+                boost::shared_ptr<const pinocchio::Model> &model, std::string &error);
+
+ private:
+  RobotModelCache();
+
+  /** @brief Models parsed from a robot description */
+  struct Entry {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    std::string description;  //!< URDF of the robot, which resolves hash collisions
+    urdf::Model urdf_model;   //!< URDF model of the robot
+    pinocchio::Model model;   //!< Pinocchio model of the robot
+  };
+
+  typedef std::multimap<std::size_t, boost::weak_ptr<const Entry> > EntryMap;
+
+  boost::mutex mutex_;  //!< Protects the entries, and serializes the parsing
+  EntryMap entries_;    //!< Parsed models keyed by the hash of their URDF
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_ROBOT_MODEL_CACHE_H
@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_ROBOT_MODEL_LOADER_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_ROBOT_MODEL_LOADER_H
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <pinocchio/multibody/model.hpp>
+#include <string>
+#include <urdf/model.h>
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @class RobotModelLoader
+ * @brief Parses robot descriptions in a background thread
+ * The models are obtained from the RobotModelCache, so the GUI thread only hands them off once they are ready. A
+ * description requested while another one is being parsed replaces it, and the result of the previous one is
+ * discarded.
+ */
+class RobotModelLoader {
+ public:
+  /** @brief Constructor function */
+  RobotModelLoader();
+
+  /** @brief Destructor function that stops the background thread */
+  ~RobotModelLoader();
+
+  /**
+   * @brief Request the models of a robot description, which starts the background thread if needed
+   * @param description  URDF of the robot
+   */
+  void load(const std::string &description);
+
+  /** @brief Discard the requested description and the models that were not handed off */
+  void cancel();
+
+  /**
+   * @brief Hand off the models of the latest requested description once they are ready
+   * @param urdf_model  URDF model of the robot, which is null if the description cannot be parsed
+   * @param model       Pinocchio model of the robot, which is null if the description cannot be parsed
+   * @param error       Reason of the failure
+   * @return True if the loading of the requested description finished
+   */
+  bool getModel(boost::shared_ptr<const urdf::Model> &urdf_model, boost::shared_ptr<const pinocchio::Model> &model,
+                std::string &error);
+
+ private:
+  /** @brief Loop of the background thread */
+  void run();
+
+  boost::thread thread_;                             //!< Background thread
+  boost::mutex mutex_;                               //!< Protects the request and the result
+  boost::condition_variable condition_;              //!< Wakes up the background thread
+  std::string pending_description_;                  //!< Description waiting to be parsed
+  bool has_pending_description_;                     //!< Whether a description is waiting to be parsed
+  std::size_t request_;                              //!< Identifier of the latest request
+  bool has_result_;                                  //!< Whether the result of the latest request is ready
+  boost::shared_ptr<const urdf::Model> urdf_model_;  //!< URDF model of the latest request
+  boost::shared_ptr<const pinocchio::Model> model_;  //!< Pinocchio model of the latest request
+  std::string error_;                                //!< Reason of the failure of the latest request
+  bool stop_;                                        //!< Requests the background thread to stop
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_ROBOT_MODEL_LOADER_H
@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_SNAPSHOT_BUFFER_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_SNAPSHOT_BUFFER_H
+
+#include <ros/time.h>
+#include <vector>
+
+#include "whole_body_state_rviz_plugin/WholeBodyStateProcessor.h"
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @class SnapshotBuffer
+ * @brief Time-indexed buffer of the latest render snapshots of a robot, which are interpolated at render time
+ * The snapshots are already decoded, so sampling the buffer only blends them: positions are linearly interpolated and
+ * orientations are slerped, including the link placements. Quantities that cannot be blended, e.g. a support region
+ * or contacts that changed, are taken from the nearest snapshot. The buffer has a fixed capacity and reuses the
+ * memory of its snapshots.
+ */
+class SnapshotBuffer {
+ public:
+  /**
+   * @brief Constructor function
+   * @param capacity  Number of buffered snapshots
+   */
+  explicit SnapshotBuffer(std::size_t capacity = 32);
+
+  /**
+   * @brief Add the latest snapshot, which replaces the oldest one if the buffer is full
+   * A snapshot that is not newer than the buffered ones, e.g. after a time jump, clears the buffer.
+   * @param snapshot  Render snapshot with a non-zero stamp
+   */
+  void push(const WholeBodyStateSnapshot &snapshot);
+
+  /**
+   * @brief Sample the buffered snapshots at a given time
+   * The time is clamped to the buffered interval, and the snapshots older than the sampled interval are discarded.
+   * @param time      Sampled time
+   * @param snapshot  Snapshot at the sampled time, whose posture identifier is zero if the placements are blended
+   * @return False if the buffer is empty or the sampled snapshot did not change since the last call
+   */
+  bool sample(const ros::Time &time, WholeBodyStateSnapshot &snapshot);
+
+  /** @brief Discard all the buffered snapshots */
+  void clear();
+
+  /** @brief Return the number of buffered snapshots */
+  std::size_t size() const { return size_; }
+
+ private:
+  /** @brief Return the i-th buffered snapshot, from the oldest one */
+  const WholeBodyStateSnapshot &at(std::size_t i) const { return snapshots_[(first_ + i) % snapshots_.size()]; }
+
+  /**
+   * @brief Blend two snapshots
+   * @param from      Older snapshot
+   * @param to        Newer snapshot
+   * @param alpha     Interpolation factor in [0, 1]
+   * @param snapshot  Blended snapshot
+   */
+  static void interpolate(const WholeBodyStateSnapshot &from, const WholeBodyStateSnapshot &to, double alpha,
+                          WholeBodyStateSnapshot &snapshot);
+
+  std::vector<WholeBodyStateSnapshot, Eigen::aligned_allocator<WholeBodyStateSnapshot>> snapshots_;  //!< Ring buffer
+  std::size_t first_;     //!< Index of the oldest snapshot
+  std::size_t size_;      //!< Number of buffered snapshots
+  bool held_;             //!< Whether the last sample was clamped to a buffered snapshot
+  ros::Time held_stamp_;  //!< Stamp of the snapshot of the last clamped sample
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_SNAPSHOT_BUFFER_H
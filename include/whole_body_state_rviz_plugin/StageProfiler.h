@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_STAGE_PROFILER_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_STAGE_PROFILER_H
+
+#include <boost/thread/mutex.hpp>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace whole_body_state_rviz_plugin {
+
+/** @brief Timing statistics of a processing stage, in seconds */
+struct StageStatistics {
+  StageStatistics() : samples(0), mean(0.), p95(0.), max(0.) {}
+
+  std::size_t samples;  //!< Number of samples in the rolling window
+  double mean;          //!< Mean duration
+  double p95;           //!< 95th percentile of the duration
+  double max;           //!< Maximum duration
+};
+
+/**
+ * @class StageProfiler
+ * @brief Collects the durations of the processing stages of a display
+ * Each stage keeps a rolling window of its latest durations. The statistics are computed only when they are reported,
+ * and they can be appended to a CSV file. Durations can be recorded from any thread.
+ */
+class StageProfiler {
+ public:
+  /** @brief Processing stages */
+  enum Stage { TRANSFORM_LOOKUP, FORWARD_KINEMATICS, CONTACT_LOOP, VISUAL_UPDATE, POLYGON_BUILD, NUM_STAGES };
+
+  /**
+   * @class ScopedTimer
+   * @brief Records the lifetime of the timer as the duration of a stage
+   * It does nothing if the profiler is null or disabled when the timer is created.
+   */
+  class ScopedTimer {
+   public:
+    ScopedTimer(StageProfiler *profiler, Stage stage);
+    ~ScopedTimer();
+
+    /** @brief Record the duration so far, the timer does nothing afterwards */
+    void stop();
+
+   private:
+    StageProfiler *profiler_;                           //!< Profiler, or null if the stage is not recorded
+    Stage stage_;                                       //!< Timed stage
+    std::chrono::steady_clock::time_point start_time_;  //!< Time at which the timer was created
+  };
+
+  /**
+   * @brief Constructor function
+   * @param window  Number of durations kept per stage
+   */
+  explicit StageProfiler(std::size_t window = 500);
+
+  /** @brief Destructor function that closes the CSV file */
+  ~StageProfiler();
+
+  /**
+   * @brief Enable or disable the recording of durations
+   * Disabling the profiler discards the recorded durations.
+   * @param enabled  Enable flag
+   */
+  void setEnabled(bool enabled);
+
+  /** @brief Return true if the durations are recorded */
+  bool isEnabled() const { return enabled_; }
+
+  /**
+   * @brief Record the duration of a stage
+   * @param stage     Processing stage
+   * @param duration  Duration in seconds
+   */
+  void record(Stage stage, double duration);
+
+  /** @brief Discard the recorded durations */
+  void reset();
+
+  /**
+   * @brief Open the CSV file where the reports are appended
+   * @param path  Path of the file, which is overwritten
+   * @return False if the file could not be opened
+   */
+  bool openCsv(const std::string &path);
+
+  /** @brief Close the CSV file */
+  void closeCsv();
+
+  /**
+   * @brief Get the statistics of a stage
+   * @param stage       Processing stage
+   * @param statistics  Statistics of the stage
+   * @return False if the stage has no samples
+   */
+  bool getStatistics(Stage stage, StageStatistics &statistics) const;
+
+  /**
+   * @brief Report the statistics of the stages with samples
+   * The statistics are also appended to the CSV file if it is open.
+   * @param time  Time of the report, used by the CSV file
+   * @return Summary of the statistics in milliseconds
+   */
+  std::string report(double time);
+
+  /** @brief Return the name of a stage */
+  static const char *getStageName(Stage stage);
+
+ private:
+  /** @brief Rolling window of durations of a stage */
+  struct StageSamples {
+    StageSamples() : next(0) {}
+
+    std::vector<double> durations;  //!< Durations in seconds
+    std::size_t next;               //!< Index overwritten by the next duration once the window is full
+  };
+
+  std::atomic<bool> enabled_;           //!< Whether the durations are recorded
+  std::size_t window_;                  //!< Number of durations kept per stage
+  StageSamples stages_[NUM_STAGES];     //!< Durations of each stage
+  mutable boost::mutex mutex_;          //!< Protects the durations
+  std::ofstream csv_;                   //!< CSV file where the reports are appended
+  mutable std::vector<double> sorted_;  //!< Buffer used to compute the percentiles
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_STAGE_PROFILER_H
@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_TRAIL_VISUAL_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_TRAIL_VISUAL_H
+
+#include <OgreMaterial.h>
+#include <OgreVector3.h>
+#include <cstdint>
+#include <vector>
+
+namespace Ogre {
+class SceneManager;
+class SceneNode;
+}  // namespace Ogre
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @class TrailVisual
+ * @brief Visualizes the recent history of a 3d point as a line
+ * The segments of the trail are stored in a ring buffer with a fixed capacity, which is drawn as a single dynamic line
+ * list. Adding a point only uploads its segment, and the segments older than the trail duration are collapsed in
+ * place. Therefore, the trail uses constant memory and one draw call regardless of its length.
+ */
+class TrailVisual {
+ public:
+  /**
+   * @brief Constructor that creates the visual stuff and puts it into the scene
+   * @param scene_manager  Manager the organization and rendering of the scene
+   * @param parent_node    Represent the trail as node in the scene
+   */
+  TrailVisual(Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent_node);
+
+  /** @brief Destructor that removes the visual stuff from the scene */
+  ~TrailVisual();
+
+  /**
+   * @brief Extend the trail to a new point
+   * The point is connected to the previous one, unless the trail was broken. A point older than the previous one,
+   * e.g. after a time jump, clears the trail.
+   * @param point  Point in the frame of the parent node
+   * @param time   Time of the point in seconds
+   */
+  void addPoint(const Ogre::Vector3 &point, double time);
+
+  /** @brief Break the trail, so the next point is not connected to the previous one */
+  void breakLine() { has_last_point_ = false; }
+
+  /** @brief Remove all the segments of the trail */
+  void clear();
+
+  /**
+   * @brief Set the time during which the segments are kept
+   * @param duration  Duration in seconds
+   */
+  void setDuration(double duration) { duration_ = duration; }
+
+  /**
+   * @brief Set the maximum number of segments, which reallocates the trail if it changed
+   * @param capacity  Number of segments
+   */
+  void setCapacity(std::size_t capacity);
+
+  /**
+   * @brief Set the color and alpha of the trail
+   * @param r  Red value
+   * @param g  Green value
+   * @param b  Blue value
+   * @param a  Alpha value
+   */
+  void setColor(float r, float g, float b, float a);
+
+  /**
+   * @brief Show or hide the visual
+   * @param visible  Visibility flag
+   */
+  void setVisible(bool visible);
+
+  /** @brief Return the number of segments in the trail */
+  std::size_t size() const { return size_; }
+
+ private:
+  class Renderable;
+
+  /** @brief Vertex of the line list, whose layout matches the vertex declaration */
+  struct Vertex {
+    float x, y, z;   //!< Position
+    uint32_t color;  //!< Packed color
+  };
+
+  /** @brief Collapse the segments older than the trail duration */
+  void expire(double time);
+
+  /**
+   * @brief Upload a range of segments to the vertex buffer
+   * @param first  Index of the first segment
+   * @param n      Number of segments
+   */
+  void upload(std::size_t first, std::size_t n);
+
+  Ogre::SceneManager *scene_manager_;  //!< Manager used to destroy the node
+  Ogre::SceneNode *frame_node_;        //!< Node of the trail
+  Renderable *line_;                   //!< Dynamic line list of the trail
+  Ogre::MaterialPtr material_;         //!< Material without lighting, whose color is defined per vertex
+  std::vector<Vertex> vertices_;       //!< Copy of the vertex buffer, two vertices per segment
+  std::vector<double> times_;          //!< Time of each segment
+  std::size_t first_;                  //!< Index of the oldest segment
+  std::size_t size_;                   //!< Number of segments
+  double duration_;                    //!< Time during which the segments are kept
+  uint32_t color_;                     //!< Packed color of the segments
+  Ogre::Vector3 last_point_;           //!< Point of the latest segment end
+  double last_time_;                   //!< Time of the latest point
+  bool has_last_point_;                //!< Whether the next point is connected to the latest one
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_TRAIL_VISUAL_H
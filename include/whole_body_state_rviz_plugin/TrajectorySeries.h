@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_TRAJECTORY_SERIES_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_TRAJECTORY_SERIES_H
+
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+#include <whole_body_state_msgs/WholeBodyState.h>
+#include <vector>
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @brief Knots of a trajectory series expressed in the fixed frame
+ * The knots are sampled once per message, and their memory is reused by the following messages.
+ */
+struct TrajectorySeries {
+  /** @brief Remove all the knots */
+  void clear() {
+    positions.clear();
+    orientations.clear();
+  }
+
+  /** @brief Return the number of knots */
+  std::size_t size() const { return positions.size(); }
+
+  /** @brief Return true if both series have the same knots */
+  bool operator==(const TrajectorySeries &other) const;
+
+  std::vector<Eigen::Vector3d> positions;                                                      //!< Knot positions
+  std::vector<Eigen::Quaterniond, Eigen::aligned_allocator<Eigen::Quaterniond>> orientations;  //!< Knot orientations
+};
+
+/**
+ * @brief Sample the CoM trajectory and the base orientations of the knots
+ * The knots that are not finite are reset to the origin and the identity orientation.
+ * @param trajectory   Knots of a whole-body trajectory
+ * @param position     Position of the message frame in the fixed frame
+ * @param orientation  Orientation of the message frame in the fixed frame
+ * @param knots        CoM series
+ */
+void sampleCoMTrajectory(const std::vector<whole_body_state_msgs::WholeBodyState> &trajectory,
+                         const Eigen::Vector3d &position, const Eigen::Quaterniond &orientation,
+                         TrajectorySeries &knots);
+
+/**
+ * @brief Sample one end-effector trajectory per contact name
+ * The series are ordered by the first appearance of their contact name. Once a contact appears, its series follows
+ * the index of that contact in the following knots. The knots that are not finite are reset to the origin and the
+ * identity orientation.
+ * @param trajectory   Knots of a whole-body trajectory
+ * @param position     Position of the message frame in the fixed frame
+ * @param orientation  Orientation of the message frame in the fixed frame
+ * @param knots        End-effector series, which is resized to the number of contact names
+ */
+void sampleContactTrajectories(const std::vector<whole_body_state_msgs::WholeBodyState> &trajectory,
+                               const Eigen::Vector3d &position, const Eigen::Quaterniond &orientation,
+                               std::vector<TrajectorySeries> &knots);
+
+/**
+ * @brief Sample the axes drawn along a series
+ * The axes are spaced according to their scale, starting from the first knot of the series. If they exceed the
+ * maximum count, then an evenly spaced subset of them is kept.
+ * @param knots     Knots of the series
+ * @param scale     Axes scale
+ * @param max_axes  Maximum number of axes
+ * @param axes      Sampled axes
+ */
+void sampleAxes(const TrajectorySeries &knots, double scale, std::size_t max_axes, TrajectorySeries &axes);
+
+/**
+ * @brief Compute the vertices of the triads drawn at the axes
+ * Each triad is a line list of three segments, i.e., the origin and the tip of the x, y and z axes in this order.
+ * @param axes      Axes of a series
+ * @param length    Length of the triad segments
+ * @param vertices  Vertices of the line list, six per axes
+ */
+void computeAxesVertices(const TrajectorySeries &axes, double length, Eigen::Matrix3Xd &vertices);
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_TRAJECTORY_SERIES_H
@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_TRANSFORM_CACHE_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_TRANSFORM_CACHE_H
+
+#include <OgreQuaternion.h>
+#include <OgreVector3.h>
+#include <ros/time.h>
+#include <string>
+#include <vector>
+
+namespace rviz {
+class FrameManager;
+}
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @class TransformCache
+ * @brief Caches the transforms of the message frames into the fixed frame
+ * The transforms are keyed by frame, stamp and fixed frame, so that the processing stages of a message share a single
+ * TF lookup. Failed lookups are not cached, and transforms at the latest available time (zero stamp) are only valid
+ * until the next render frame.
+ */
+class TransformCache {
+ public:
+  /**
+   * @brief Constructor function
+   * @param capacity  Number of cached transforms
+   */
+  explicit TransformCache(std::size_t capacity = 8);
+
+  /**
+   * @brief Get the transform of a frame into the fixed frame, either from the cache or from the frame manager
+   * @param frame_manager  Frame manager used on a cache miss
+   * @param frame_id       Frame of the message
+   * @param stamp          Stamp of the message
+   * @param position       Position of the frame in the fixed frame
+   * @param orientation    Orientation of the frame in the fixed frame
+   * @return False if the transform is not available
+   */
+  bool getTransform(rviz::FrameManager *frame_manager, const std::string &frame_id, const ros::Time &stamp,
+                    Ogre::Vector3 &position, Ogre::Quaternion &orientation);
+
+  /** @brief Discard all the cached transforms, e.g. when the fixed frame changes */
+  void clear();
+
+  /** @brief Discard the transforms at the latest available time, it is called once per render frame */
+  void expireLatest();
+
+  /** @brief Return the number of lookups served by the cache */
+  std::size_t getHits() const { return hits_; }
+
+  /** @brief Return the number of lookups forwarded to the frame manager */
+  std::size_t getMisses() const { return misses_; }
+
+ private:
+  /** @brief Cached transform */
+  struct Entry {
+    std::string frame_id;          //!< Frame of the message
+    ros::Time stamp;               //!< Stamp of the message
+    std::string fixed_frame;       //!< Fixed frame at the time of the lookup
+    Ogre::Vector3 position;        //!< Position of the frame in the fixed frame
+    Ogre::Quaternion orientation;  //!< Orientation of the frame in the fixed frame
+  };
+
+  std::vector<Entry> entries_;  //!< Cached transforms
+  std::size_t capacity_;        //!< Number of cached transforms
+  std::size_t next_;            //!< Entry overwritten by the next miss once the cache is full
+  std::size_t hits_;            //!< Number of lookups served by the cache
+  std::size_t misses_;          //!< Number of lookups forwarded to the frame manager
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_TRANSFORM_CACHE_H
@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_VISUAL_POOL_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_VISUAL_POOL_H
+
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+namespace Ogre {
+class SceneManager;
+class SceneNode;
+}  // namespace Ogre
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @class VisualPool
+ * @brief Keeps a set of visuals alive across messages
+ * Visuals are created or destroyed only when the requested number of visuals changes. Therefore, a steady-state
+ * stream only updates their pose, scale and color in place. The pool counts the visuals it has created, which lets
+ * the display check that no scene nodes are allocated per message.
+ */
+template <class VisualType>
+class VisualPool {
+ public:
+  typedef boost::shared_ptr<VisualType> VisualPtr;
+
+  /** @brief Constructor function */
+  VisualPool() : scene_manager_(nullptr), parent_node_(nullptr), allocations_(0) {}
+
+  /**
+   * @brief Set the scene in which the visuals are created
+   * @param scene_manager  Manager the organization and rendering of the scene
+   * @param parent_node    Node that owns the visuals of the pool
+   */
+  void initialize(Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent_node) {
+    clear();
+    scene_manager_ = scene_manager;
+    parent_node_ = parent_node;
+  }
+
+  /**
+   * @brief Grow or shrink the pool to a given number of visuals
+   * @param n  Number of visuals
+   * @return True if new visuals were created
+   */
+  bool resize(std::size_t n) {
+    const std::size_t current = visuals_.size();
+    if (n < current) {
+      visuals_.resize(n);
+      return false;
+    }
+    visuals_.reserve(n);
+    for (std::size_t i = current; i < n; ++i) {
+      visuals_.push_back(VisualPtr(new VisualType(scene_manager_, parent_node_)));
+      ++allocations_;
+    }
+    return n > current;
+  }
+
+  /** @brief Show or hide all the visuals of the pool */
+  void setVisible(bool visible) {
+    for (std::size_t i = 0; i < visuals_.size(); ++i) {
+      visuals_[i]->setVisible(visible);
+    }
+  }
+
+  /** @brief Destroy all the visuals of the pool */
+  void clear() { visuals_.clear(); }
+
+  /** @brief Return the number of visuals */
+  std::size_t size() const { return visuals_.size(); }
+
+  /** @brief Return the i-th visual */
+  const VisualPtr &operator[](std::size_t i) const { return visuals_[i]; }
+
+  /** @brief Return the number of visuals created since the pool was built */
+  std::size_t getAllocations() const { return allocations_; }
+
+ private:
+  std::vector<VisualPtr> visuals_;     //!< Visuals kept alive across messages
+  Ogre::SceneManager *scene_manager_;  //!< Scene manager used to create new visuals
+  Ogre::SceneNode *parent_node_;       //!< Parent node of the visuals
+  std::size_t allocations_;            //!< Number of visuals created
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_VISUAL_POOL_H
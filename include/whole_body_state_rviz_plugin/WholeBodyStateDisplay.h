@@ -10,7 +10,7 @@
 #ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_WHOLE_BODY_STATE_DISPLAY_H
 #define WHOLE_BODY_STATE_RVIZ_PLUGIN_WHOLE_BODY_STATE_DISPLAY_H
 
-#include <pinocchio/multibody/data.hpp>
+#include <limits>
 #include <pinocchio/multibody/model.hpp>
 #include <rviz/message_filter_display.h>
 #include <rviz/properties/color_property.h>
@@ -18,12 +18,24 @@
 #include <rviz/properties/float_property.h>
 #include <rviz/properties/int_property.h>
 #include <rviz/robot/robot.h>
+#include <tf2_ros/message_filter.h>
 #include <whole_body_state_msgs/WholeBodyState.h>
 
 #include "whole_body_state_rviz_plugin/ArrowVisual.h"
 #include "whole_body_state_rviz_plugin/PointVisual.h"
 #include "whole_body_state_rviz_plugin/PolygonVisual.h"
+#include "whole_body_state_rviz_plugin/StageProfiler.h"
 #include "whole_body_state_rviz_plugin/ConeVisual.h"
+#include "whole_body_state_rviz_plugin/DisplaySettings.h"
+#include "whole_body_state_rviz_plugin/GhostVisual.h"
+#include "whole_body_state_rviz_plugin/InputPolicyFilter.h"
+#include "whole_body_state_rviz_plugin/RenderBudget.h"
+#include "whole_body_state_rviz_plugin/RobotModelLoader.h"
+#include "whole_body_state_rviz_plugin/SnapshotBuffer.h"
+#include "whole_body_state_rviz_plugin/TrailVisual.h"
+#include "whole_body_state_rviz_plugin/TransformCache.h"
+#include "whole_body_state_rviz_plugin/VisualPool.h"
+#include "whole_body_state_rviz_plugin/WholeBodyStateProcessor.h"
 
 namespace Ogre {
 class SceneNode;
@@ -47,6 +59,8 @@ namespace whole_body_state_rviz_plugin {
 class WholeBodyStateDisplay : public rviz::MessageFilterDisplay<whole_body_state_msgs::WholeBodyState> {
   Q_OBJECT
  public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
   /** @brief Constructor function */
   WholeBodyStateDisplay();
 
@@ -70,13 +84,13 @@ class WholeBodyStateDisplay : public rviz::MessageFilterDisplay<whole_body_state
 
   /**
    * @brief Function to handle an incoming ROS message
-   * This is our callback to handle an incoming message
+   * This is our callback to handle an incoming message, which is queued for the background processing thread
    * @param const whole_body_state_msgs::WholeBodyState::ConstPtr& Whole-body
    * state msg
    */
   void processMessage(const whole_body_state_msgs::WholeBodyState::ConstPtr &msg) override;
 
-  /** @brief render callback */
+  /** @brief render callback that applies the latest snapshot of each robot */
   void update(float wall_dt, float ros_dt) override;
 
  private Q_SLOTS:
@@ -85,9 +99,11 @@ class WholeBodyStateDisplay : public rviz::MessageFilterDisplay<whole_body_state
    * Set the current color and alpha values for each visual */
   void updateRobotEnable();
   void updateRobotModel();
+  void updateAdditionalTopics();
   void updateRobotVisualVisible();
   void updateRobotCollisionVisible();
   void updateRobotAlpha();
+  void updatePostureTolerance();
   void updateCoMEnable();
   void updateCoMStyle();
   void updateCoMColorAndAlpha();
@@ -111,10 +127,183 @@ class WholeBodyStateDisplay : public rviz::MessageFilterDisplay<whole_body_state
   void updateFrictionConeColorAndAlpha();
   void updateFrictionConeGeometry();
   void updateFrictionConeOrigin();
+  void updateInputPolicy();
+  void updateProfiling();
+  void updateRenderBudget();
+  void updateTrackTransform();
+  void updateInterpolationDelay();
+  void updateTrailEnable();
+  void updateTrailHistory();
+  void updateGhostEnable();
+  void updateGhostHistory();
+  void updateGhostAlpha();
   /**@}*/
 
  private:
-  void processWholeBodyState();
+  typedef message_filters::Subscriber<whole_body_state_msgs::WholeBodyState> TopicSubscriber;
+  typedef InputPolicyFilter<whole_body_state_msgs::WholeBodyState> InputFilter;
+  typedef tf2_ros::MessageFilter<whole_body_state_msgs::WholeBodyState> TFFilter;
+
+  /**
+   * @brief Robot displayed by this display
+   * All the robots share the robot model, the settings and the transform cache of the display, while each one owns
+   * its processing thread, pinocchio data and visuals. The first robot is fed by the topic of the display, and the
+   * other ones by the additional topics, each one through an input policy and a TF filter of its own.
+   */
+  struct RobotInstance {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    RobotInstance()
+        : has_snapshot(false),
+          posture_id(std::numeric_limits<std::size_t>::max()),
+          applied_snapshots(0),
+          root_node(nullptr),
+          next_ghost(0),
+          ghost_time(-std::numeric_limits<double>::infinity()),
+          visual_allocations(0) {}
+
+    std::string topic;                                            //!< Additional topic, empty for the display topic
+    TopicSubscriber subscriber;                                   //!< Subscriber of the additional topic
+    InputFilter input_filter;                                     //!< Input policy of the additional topic
+    boost::shared_ptr<TFFilter> tf_filter;                        //!< TF filter of the additional topic
+    whole_body_state_msgs::WholeBodyState::ConstPtr pending_msg;  //!< Latest message received while loading the model
+    WholeBodyStateProcessor processor;                            //!< Computes the render snapshots in the background
+    WholeBodyStateSnapshot snapshot;                              //!< Snapshot currently displayed
+    WholeBodyStateSnapshot received_snapshot;                     //!< Latest snapshot received from the processor
+    SnapshotBuffer snapshot_buffer;                               //!< Received snapshots that are interpolated
+    bool has_snapshot;                                            //!< Whether the snapshot belongs to the model
+    std::size_t posture_id;                                       //!< Posture of the snapshot applied to the links
+    std::size_t applied_snapshots;                                //!< Number of new snapshots applied to the visuals
+
+    Ogre::SceneNode *root_node;  //!< Node posed at the message frame, which is the parent of the overlays
+
+    /**@{*/
+    /** Object for visualization of the data */
+    boost::shared_ptr<rviz::Robot> robot;
+    boost::shared_ptr<PointVisual> com_visual;
+    boost::shared_ptr<ArrowVisual> comd_visual;
+    boost::shared_ptr<PointVisual> zmp_visual;
+    boost::shared_ptr<PointVisual> cmp_visual;
+    boost::shared_ptr<PointVisual> icp_visual;
+    VisualPool<ArrowVisual> grf_visual;
+    boost::shared_ptr<ArrowVisual> net_grf_visual;
+    boost::shared_ptr<PolygonVisual> support_visual;
+    VisualPool<ConeVisual> cones_visual;
+    VisualPool<PointVisual> cop_visual;
+    boost::shared_ptr<TrailVisual> com_trail;
+    boost::shared_ptr<TrailVisual> zmp_trail;
+    boost::shared_ptr<TrailVisual> icp_trail;
+    boost::shared_ptr<TrailVisual> cmp_trail;
+    VisualPool<TrailVisual> cop_trail;
+    /**@}*/
+
+    std::vector<boost::shared_ptr<GhostVisual> > ghosts;  //!< Copies of the robot that show the latest postures
+    std::size_t next_ghost;                               //!< Ghost that shows the next captured posture
+    double ghost_time;                                    //!< Time of the latest captured posture
+
+    std::size_t visual_allocations;  //!< Number of single visuals created since the display was enabled
+  };
+
+  /**
+   * @brief Handle an incoming message of an additional topic
+   * It is called by the TF filter of the topic, as done by processMessage() for the topic of the display.
+   * @param msg    Whole-body state msg
+   * @param robot  Robot of the topic
+   */
+  void processRobotMessage(const whole_body_state_msgs::WholeBodyState::ConstPtr &msg, RobotInstance *robot);
+
+  /**
+   * @brief Queue a message for the processing thread of a robot
+   * @param robot  Robot of the message
+   * @param msg    Whole-body state msg
+   */
+  void submitMessage(RobotInstance &robot, const whole_body_state_msgs::WholeBodyState::ConstPtr &msg);
+
+  /** @brief Return the processing parameters of the messages, which are shared by all the robots */
+  ProcessingParameters getProcessingParameters() const;
+
+  /**
+   * @brief Create a robot, which is started and loaded when the display is enabled
+   * @param topic  Additional topic of the robot, it is empty for the topic of the display
+   */
+  boost::shared_ptr<RobotInstance> createRobot(const std::string &topic);
+
+  /** @brief Subscribe a robot to its additional topic */
+  void subscribeRobot(RobotInstance &robot);
+
+  /**
+   * @brief Set the input policy of a topic from the display properties
+   * @param filter  Input policy filter of the topic
+   */
+  void applyInputPolicy(InputFilter &filter);
+
+  /**
+   * @brief Receive the snapshots of a robot into its buffer, and sample the buffer at the display time
+   * @param robot  Robot of the snapshots
+   * @param time   Display time, which is delayed w.r.t. the current time
+   * @return True if the displayed snapshot changed
+   */
+  bool receiveSnapshot(RobotInstance &robot, const ros::Time &time);
+
+  /**
+   * @brief Pose the root node and the robot at the frame of the current snapshot of a robot
+   * It is the only update needed when the fixed frame changes.
+   * @param robot   Robot of the snapshot
+   * @param latest  Whether to use the latest transform instead of the one at the snapshot stamp
+   * @return False if the robot has no snapshot or its transform is not available
+   */
+  bool poseRobot(RobotInstance &robot, bool latest);
+
+  /**
+   * @brief Apply the current snapshot of a robot to its visuals, which only runs Ogre updates and a transform
+   * @param robot     Robot of the snapshot
+   * @param received  Whether the snapshot is new, or it is applied again after a change of the settings
+   */
+  void applySnapshot(RobotInstance &robot, bool received);
+
+  /** @brief Apply the contacts of the current snapshot of a robot to its contact visuals */
+  void applyContactSnapshot(RobotInstance &robot);
+
+  /**
+   * @brief Capture the posture of the current snapshot of a robot into its oldest ghost
+   * The posture is captured once the ghost spacing elapsed since the latest one. Only the ghost that captures it is
+   * posed, from the link placements that were computed when the snapshot arrived.
+   * @param robot  Robot of the snapshot
+   */
+  void captureGhost(RobotInstance &robot);
+
+  /**
+   * @brief Create the ghosts of a robot from its loaded links
+   * They are created once when the ghosts are enabled or the robot model is handed off, and they are hidden until
+   * they capture a posture.
+   * @param robot  Robot of the ghosts
+   */
+  void createGhosts(RobotInstance &robot);
+
+  /** @brief Hide the ghosts of a robot, so they capture the following postures again */
+  void clearGhosts(RobotInstance &robot);
+
+  /** @brief Destroy the ghosts of a robot */
+  void destroyGhosts(RobotInstance &robot);
+
+  /** @brief Remove the segments of the trails of a robot */
+  void clearTrails(RobotInstance &robot);
+
+  /** @brief Apply the current level of detail of the render budget to the visuals of all the robots */
+  void applyRenderLevel();
+
+  /**
+   * @brief Push the appearance settings to the visuals of all the robots
+   * @param groups  Appearance groups to push, see Settings::Group
+   */
+  void applySettings(unsigned int groups);
+
+  /**
+   * @brief Push the appearance settings to the visuals of a robot
+   * @param robot   Robot of the visuals
+   * @param groups  Appearance groups to push, see Settings::Group
+   */
+  void applySettings(RobotInstance &robot, unsigned int groups);
 
   /** @brief Loads a URDF from the ros-param named by our
    * "Robot Description" property, iterates through the links, and
@@ -122,14 +311,31 @@ class WholeBodyStateDisplay : public rviz::MessageFilterDisplay<whole_body_state
    */
   void loadRobotModel();
 
+  /** @brief Hand off the robot model to the robots once it was parsed in the background */
+  void handOffRobotModel();
+
   /** @brief Clear the robot model */
   void clearRobotModel();
 
-  /** @brief Whole-body state message */
-  whole_body_state_msgs::WholeBodyState::ConstPtr msg_;
+  /** @brief Create the visuals of a robot, which are kept alive while the display is enabled */
+  void createVisuals(RobotInstance &robot);
+
+  /** @brief Destroy all the visuals of a robot */
+  void destroyVisuals(RobotInstance &robot);
 
-  bool has_new_msg_;  ///< Callback sets this to tell our update function
-                      ///< it needs to update the model
+  /** @brief Return the number of visuals created since the display was enabled */
+  std::size_t getVisualAllocations() const;
+
+  StageProfiler profiler_;                                 //!< Records the processing stages, it outlives the robots
+  std::vector<boost::shared_ptr<RobotInstance> > robots_;  //!< Displayed robots, the first one uses the display topic
+
+  InputFilter input_filter_;             //!< Decimates the incoming messages before the TF filter
+  std::size_t processed_messages_;       //!< Number of snapshots applied to the visuals
+  TransformCache transform_cache_;       //!< Transforms of the message frames into the fixed frame
+  float status_elapsed_;                 //!< Time elapsed since the periodic statuses were reported
+  std::size_t last_visual_allocations_;  //!< Number of visual allocations reported in the last frame
+  RenderBudget render_budget_;           //!< Selects the level of detail of the contact overlays
+  Ogre::MaterialPtr ghost_material_;     //!< Translucent material shared by the ghosts of all the robots
 
   /**@{*/
   /** Properties to show on side panel */
@@ -142,29 +348,19 @@ class WholeBodyStateDisplay : public rviz::MessageFilterDisplay<whole_body_state
   rviz::Property *grf_category_;
   rviz::Property *support_category_;
   rviz::Property *friction_category_;
-  /**@}*/
-
-  /**@{*/
-  /** Object for visualization of the data */
-  boost::shared_ptr<rviz::Robot> robot_;
-  boost::shared_ptr<PointVisual> com_visual_;
-  boost::shared_ptr<ArrowVisual> comd_visual_;
-  boost::shared_ptr<PointVisual> zmp_visual_;
-  boost::shared_ptr<PointVisual> cmp_visual_;
-  boost::shared_ptr<PointVisual> icp_visual_;
-  std::vector<boost::shared_ptr<ArrowVisual>> grf_visual_;
-  boost::shared_ptr<PolygonVisual> support_visual_;
-  std::vector<boost::shared_ptr<ConeVisual>> cones_visual_;
-  std::vector<boost::shared_ptr<PointVisual>> cop_visual_;
+  rviz::Property *trail_category_;
+  rviz::Property *ghost_category_;
   /**@}*/
 
   /**@{*/
   /** Property objects for user-editable properties */
   rviz::BoolProperty *robot_enable_property_;
   rviz::StringProperty *robot_model_property_;
+  rviz::StringProperty *additional_topics_property_;
   rviz::Property *robot_visual_enabled_property_;
   rviz::Property *robot_collision_enabled_property_;
   rviz::FloatProperty *robot_alpha_property_;
+  rviz::FloatProperty *robot_posture_tolerance_property_;
   rviz::BoolProperty *com_enable_property_;
   rviz::EnumProperty *com_style_property_;
   rviz::ColorProperty *com_color_property_;
@@ -215,44 +411,107 @@ class WholeBodyStateDisplay : public rviz::MessageFilterDisplay<whole_body_state
   rviz::FloatProperty *friction_cone_alpha_property_;
   rviz::FloatProperty *friction_cone_length_property_;
   rviz::BoolProperty *friction_cone_locate_at_cop_property_;
+  rviz::EnumProperty *input_policy_property_;
+  rviz::FloatProperty *input_max_rate_property_;
+  rviz::IntProperty *input_keep_every_property_;
+  rviz::BoolProperty *profiling_enable_property_;
+  rviz::StringProperty *profiling_csv_property_;
+  rviz::FloatProperty *render_budget_property_;
+  rviz::BoolProperty *track_transform_property_;
+  rviz::FloatProperty *interpolation_delay_property_;
+  rviz::BoolProperty *trail_enable_property_;
+  rviz::FloatProperty *trail_duration_property_;
+  rviz::IntProperty *trail_capacity_property_;
+  rviz::BoolProperty *ghost_enable_property_;
+  rviz::IntProperty *ghost_count_property_;
+  rviz::FloatProperty *ghost_spacing_property_;
+  rviz::FloatProperty *ghost_alpha_property_;
   /**@}*/
 
   /**@{*/
   /** @brief Robot and whole-boyd variables */
   std::string robot_model_;
   bool initialized_model_;
-  pinocchio::Model model_;
-  pinocchio::Data data_;
-  double force_threshold_;   //!< Force threshold for detecting active contacts
-  double torque_threshold_;  //!< Torque threshold for detecting whether contact is point (3d) or surface (6d)
-  bool use_contact_status_in_zmp_;
-  bool use_contact_status_in_cop_;
-  bool use_contact_status_in_grf_;
-  bool use_contact_status_in_support_;
-  bool use_contact_status_in_friction_cone_;
-  bool grf_locate_at_cop_;            //!< Whether to locate ground reaction forces at foot center of pressures
-  bool friction_cone_locate_at_cop_;  //!< Whether to locate friction cones at foot center of pressures
-  double weight_;
-  double gravity_;
-  double friction_mu_;
+  boost::shared_ptr<const pinocchio::Model> model_;    //!< Robot model, which is shared with the processors
+  boost::shared_ptr<const urdf::Model> description_;  //!< Robot description, which is loaded by the robots
+  LinkFrames link_frames_;                            //!< Frames of the links, which index the snapshot placements
+  RobotModelLoader model_loader_;                     //!< Parses the robot description in the background
   /**@}*/
 
   enum CoMStyle { REAL, PROJECTED };  //!< CoM visualization style
-  bool com_real_;                     //!< Label to indicates the type of CoM display (real or
-                                      //!< projected)
 
-  /**@{*/
-  /** Flag that indicates if the category are enable */
-  bool robot_enable_;
-  bool com_enable_;
-  bool zmp_enable_;
-  bool cop_enable_;
-  bool icp_enable_;
-  bool cmp_enable_;
-  bool grf_enable_;
-  bool support_enable_;
-  bool cone_enable_;
-  /**@}*/
+  /**
+   * @brief Values of the display properties
+   * They are only written by the property slots, so neither the processing of a message nor the visual updates read
+   * the property tree. The appearance groups that changed since they were pushed to the visuals are flagged as dirty.
+   */
+  struct Settings {
+    /** @brief Groups of settings that are pushed to the visuals together */
+    enum Group {
+      COM_APPEARANCE = 1 << 0,
+      ZMP_APPEARANCE = 1 << 1,
+      COP_APPEARANCE = 1 << 2,
+      ICP_APPEARANCE = 1 << 3,
+      CMP_APPEARANCE = 1 << 4,
+      GRF_APPEARANCE = 1 << 5,
+      SUPPORT_LINE_APPEARANCE = 1 << 6,
+      SUPPORT_MESH_APPEARANCE = 1 << 7,
+      CONE_APPEARANCE = 1 << 8,
+      SNAPSHOT_GEOMETRY = 1 << 9,  //!< Geometry scaled by the snapshot, which is applied again
+      TRAIL_HISTORY = 1 << 10,     //!< Visibility, duration and capacity of the trails
+      ALL_GROUPS = (1 << 11) - 1
+    };
+
+    Settings();
+
+    bool robot_enable;                         //!< Whether the robot is displayed
+    bool robot_visual_enable;                  //!< Whether the visual representation of the robot is displayed
+    bool robot_collision_enable;               //!< Whether the collision representation of the robot is displayed
+    double posture_tolerance;                  //!< Configuration change below which the robot is not updated
+    bool track_transform;                      //!< Whether to pose the visuals with the latest transform every frame
+    double interpolation_delay;                //!< Delay at which the buffered snapshots are interpolated, or zero
+    bool com_enable;                           //!< Whether the CoM is displayed
+    bool com_real;                             //!< Whether to display the real or projected CoM
+    PointSettings com;                         //!< Appearance of the CoM
+    ArrowSettings com_arrow;                   //!< Geometry of the CoM velocity arrow
+    bool zmp_enable;                           //!< Whether the ZMP is displayed
+    bool use_contact_status_in_zmp;            //!< Whether to use the contact status for the ZMP
+    PointSettings zmp;                         //!< Appearance of the ZMP
+    bool cop_enable;                           //!< Whether the contact CoPs are displayed
+    bool use_contact_status_in_cop;            //!< Whether to use the contact status for the CoPs
+    PointSettings cop;                         //!< Appearance of the contact CoPs
+    bool icp_enable;                           //!< Whether the ICP is displayed
+    PointSettings icp;                         //!< Appearance of the ICP
+    bool cmp_enable;                           //!< Whether the CMP is displayed
+    PointSettings cmp;                         //!< Appearance of the CMP
+    bool grf_enable;                           //!< Whether the contact forces are displayed
+    bool use_contact_status_in_grf;            //!< Whether to use the contact status for the contact forces
+    bool grf_locate_at_cop;                    //!< Whether to locate contact forces at the contact CoPs
+    Ogre::ColourValue grf_color;               //!< Color and alpha of the contact forces
+    ArrowSettings grf_arrow;                   //!< Geometry of the contact force arrows
+    bool support_enable;                       //!< Whether the support region is displayed
+    bool use_contact_status_in_support;        //!< Whether to use the contact status for the support region
+    Ogre::ColourValue support_line_color;      //!< Color and alpha of the support region lines
+    float support_line_radius;                 //!< Radius of the support region lines
+    Ogre::ColourValue support_mesh_color;      //!< Color and alpha of the support region mesh
+    double force_threshold;                    //!< Force threshold for detecting active contacts
+    double torque_threshold;                   //!< Torque threshold for detecting surface contacts
+    bool cone_enable;                          //!< Whether the friction cones are displayed
+    bool use_contact_status_in_friction_cone;  //!< Whether to use the contact status for the friction cones
+    bool friction_cone_locate_at_cop;          //!< Whether to locate friction cones at the contact CoPs
+    Ogre::ColourValue cone_color;              //!< Color and alpha of the friction cones
+    float cone_length;                         //!< Length of the friction cones
+    bool trail_enable;                         //!< Whether the trails of the points are displayed
+    double trail_duration;                     //!< Time during which the trail segments are kept
+    std::size_t trail_capacity;                //!< Maximum number of segments per trail
+    bool ghost_enable;                         //!< Whether the ghosts of the latest postures are displayed
+    std::size_t ghost_count;                   //!< Maximum number of ghosts per robot
+    double ghost_spacing;                      //!< Time between the postures captured by the ghosts
+    float ghost_alpha;                         //!< Transparency of the ghosts
+    unsigned int dirty;                        //!< Groups that changed since they were pushed to the visuals
+  };
+
+  Settings settings_;  //!< Values of the display properties
 };
 
 }  // namespace whole_body_state_rviz_plugin
@@ -0,0 +1,231 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef WHOLE_BODY_STATE_RVIZ_PLUGIN_WHOLE_BODY_STATE_PROCESSOR_H
+#define WHOLE_BODY_STATE_RVIZ_PLUGIN_WHOLE_BODY_STATE_PROCESSOR_H
+
+#include <pinocchio/container/aligned-vector.hpp>
+#include <pinocchio/multibody/data.hpp>
+#include <pinocchio/multibody/model.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <whole_body_state_msgs/WholeBodyState.h>
+
+#include "whole_body_state_rviz_plugin/ContactFrames.h"
+#include "whole_body_state_rviz_plugin/JointConfigurationMapper.h"
+#include "whole_body_state_rviz_plugin/LinkFrames.h"
+#include "whole_body_state_rviz_plugin/StageProfiler.h"
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @brief Parameters that define how a whole-body state is processed
+ * They are copied together with each message, so the processing thread never reads the display properties.
+ */
+struct ProcessingParameters {
+  ProcessingParameters()
+      : robot_enable(true),
+        posture_tolerance(0.),
+        cop_enable(true),
+        force_threshold(0.),
+        torque_threshold(0.),
+        use_contact_status_in_zmp(true),
+        use_contact_status_in_cop(true),
+        use_contact_status_in_grf(true),
+        use_contact_status_in_support(true),
+        use_contact_status_in_friction_cone(true),
+        grf_locate_at_cop(false),
+        friction_cone_locate_at_cop(false),
+        com_real(true) {}
+
+  bool robot_enable;                         //!< Whether to compute the robot kinematics
+  double posture_tolerance;                  //!< Configuration change below which the kinematics are not computed
+  bool cop_enable;                           //!< Whether the contact CoPs are displayed
+  double force_threshold;                    //!< Force threshold for detecting active contacts
+  double torque_threshold;                   //!< Torque threshold for detecting surface contacts
+  bool use_contact_status_in_zmp;            //!< Whether to use the contact status for the ZMP
+  bool use_contact_status_in_cop;            //!< Whether to use the contact status for the CoPs
+  bool use_contact_status_in_grf;            //!< Whether to use the contact status for the contact forces
+  bool use_contact_status_in_support;        //!< Whether to use the contact status for the support region
+  bool use_contact_status_in_friction_cone;  //!< Whether to use the contact status for the friction cones
+  bool grf_locate_at_cop;                    //!< Whether to locate contact forces at the contact CoPs
+  bool friction_cone_locate_at_cop;          //!< Whether to locate friction cones at the contact CoPs
+  bool com_real;                             //!< Whether to display the real or projected CoM
+};
+
+/**
+ * @brief Precomputed render data of a single contact
+ * Positions and orientations are expressed in the message frame, except the CoP, which is expressed in the contact
+ * frame.
+ */
+struct ContactSnapshot {
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  Eigen::Vector3d position;              //!< Contact position
+  Eigen::Quaterniond orientation;        //!< Contact surface orientation
+  Eigen::Vector3d cop;                   //!< Contact center of pressure
+  Eigen::Quaterniond force_orientation;  //!< Orientation of the contact force arrow
+  double force_ratio;                    //!< Norm of the contact force normalized by the robot's weight
+  Eigen::Quaterniond cone_orientation;   //!< Orientation of the friction cone
+  double friction_mu;                    //!< Friction coefficient
+  bool cop_visible;                      //!< Whether the contact CoP is well defined and active
+  bool grf_visible;                      //!< Whether the contact force is well defined and active
+  bool grf_at_cop;                       //!< Whether the contact force is located at the contact CoP
+  bool cone_visible;                     //!< Whether the friction cone is well defined and active
+  bool cone_at_cop;                      //!< Whether the friction cone is located at the contact CoP
+};
+
+/**
+ * @brief Compact render snapshot of a whole-body state
+ * It contains everything the display needs to update its visuals, so the render thread does not run any Pinocchio
+ * algorithm.
+ */
+struct WholeBodyStateSnapshot {
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef LinkFrames::FramePlacements FramePlacements;
+
+  WholeBodyStateSnapshot()
+      : has_robot(false), posture_id(0), com_visible(false), has_support(false), net_force_visible(false) {}
+
+  std::string frame_id;                         //!< Frame of the message
+  ros::Time stamp;                              //!< Stamp of the message
+  bool has_robot;                               //!< Whether the frame placements were computed
+  FramePlacements frame_placements;             //!< Placements of the link frames, indexed as in LinkFrames
+  std::size_t posture_id;                       //!< Identifier of the placements, or zero if they are interpolated
+  Eigen::Vector3d com;                          //!< Displayed center of mass (real or projected)
+  Eigen::Vector3d com_velocity;                 //!< Center of mass velocity
+  Eigen::Quaterniond com_velocity_orientation;  //!< Orientation of the center of mass velocity arrow
+  bool com_visible;                             //!< Whether the center of mass is well defined
+  bool has_support;                             //!< Whether there are active locomotion contacts
+  Eigen::Vector3d zmp;                          //!< Zero moment point
+  Eigen::Vector3d icp;                          //!< Instantaneous capture point
+  Eigen::Vector3d cmp;                          //!< Centroidal momentum pivot
+  std::vector<Eigen::Vector3d> support;         //!< Vertices of the support region
+  bool net_force_visible;                       //!< Whether a contact force is displayed and their sum is well defined
+  Eigen::Vector3d net_force_position;           //!< Mean of the contact positions weighted by their force norms
+  Eigen::Quaterniond net_force_orientation;     //!< Orientation of the net contact force arrow
+  double net_force_ratio;                       //!< Norm of the net contact force normalized by the robot's weight
+
+  /** @brief Contact data */
+  std::vector<ContactSnapshot, Eigen::aligned_allocator<ContactSnapshot>> contacts;
+};
+
+/**
+ * @class WholeBodyStateProcessor
+ * @brief Turns whole-body state messages into render snapshots
+ * The processing can run synchronously through process(), or in a background thread through submit() and
+ * getSnapshot(). The background thread follows a latest-only policy: a message submitted while another one is waiting
+ * replaces it.
+ */
+class WholeBodyStateProcessor {
+ public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /** @brief Constructor function */
+  WholeBodyStateProcessor();
+
+  /** @brief Destructor function that stops the background thread */
+  ~WholeBodyStateProcessor();
+
+  /**
+   * @brief Set the robot model
+   * It waits for the message in process, and discards the pending message and snapshot.
+   * @param model  Pinocchio model with a free-flyer root joint
+   */
+  void setModel(const boost::shared_ptr<const pinocchio::Model> &model);
+
+  /**
+   * @brief Set the profiler that records the kinematics and contact stages
+   * It must be called before the background thread is started.
+   * @param profiler  Stage profiler, or null to disable the profiling
+   */
+  void setProfiler(StageProfiler *profiler);
+
+  /** @brief Clear the robot model, and discard the pending message and snapshot */
+  void clear();
+
+  /** @brief Start the background thread */
+  void start();
+
+  /** @brief Stop the background thread, and discard the pending message and snapshot */
+  void stop();
+
+  /**
+   * @brief Queue a message to be processed by the background thread
+   * @param msg     Whole-body state message
+   * @param params  Processing parameters
+   */
+  void submit(const whole_body_state_msgs::WholeBodyState::ConstPtr &msg, const ProcessingParameters &params);
+
+  /**
+   * @brief Get the latest snapshot computed by the background thread
+   * The snapshots are swapped, so the memory of the given snapshot is reused by the background thread.
+   * @param snapshot  Latest snapshot
+   * @return True if there was a new snapshot
+   */
+  bool getSnapshot(WholeBodyStateSnapshot &snapshot);
+
+  /**
+   * @brief Process a whole-body state in the calling thread
+   * @param msg       Whole-body state message
+   * @param params    Processing parameters
+   * @param snapshot  Render snapshot
+   * @return False if the robot model was not set
+   */
+  bool process(const whole_body_state_msgs::WholeBodyState &msg, const ProcessingParameters &params,
+               WholeBodyStateSnapshot &snapshot);
+
+ private:
+  /** @brief Loop of the background thread */
+  void run();
+
+  /** @brief Process a whole-body state, the model mutex must be locked by the caller */
+  bool compute(const whole_body_state_msgs::WholeBodyState &msg, const ProcessingParameters &params,
+               WholeBodyStateSnapshot &snapshot);
+
+  boost::shared_ptr<const pinocchio::Model> model_;  //!< Robot model
+  pinocchio::Data data_;                             //!< Robot data used by the processing
+  JointConfigurationMapper joint_mapper_;            //!< Maps the message joints into the configuration vector
+  LinkFrames link_frames_;                           //!< Frames of the links drawn by the display
+  Eigen::VectorXd q_;                                //!< Configuration vector
+  Eigen::VectorXd q_posture_;                        //!< Configuration of the latest computed posture, base at origin
+  Eigen::Vector3d com_offset_;                       //!< CoM of the latest computed posture with the base at origin
+  Eigen::Vector3d base_position_;                    //!< Base position of the latest computed link placements
+  LinkFrames::FramePlacements link_placements_;      //!< Latest computed link placements
+  bool has_posture_;                                 //!< Whether the latest posture belongs to the current model
+  std::size_t posture_id_;                           //!< Identifier of the latest computed link placements
+  double gravity_;                                   //!< Gravity acceleration
+  double weight_;                                    //!< Robot weight
+  boost::mutex model_mutex_;                         //!< Protects the model and data
+  StageProfiler *profiler_;                          //!< Records the processing stages, if not null
+
+  ContactFrames contact_frames_;           //!< Contacts of the message in process
+  Eigen::Matrix4Xd contact_orientations_;  //!< Contact surface orientations
+  Eigen::Matrix4Xd force_orientations_;    //!< Orientations of the contact force arrows
+  Eigen::Matrix4Xd cone_orientations_;     //!< Orientations of the friction cones
+  Eigen::Matrix3Xd cops_;                  //!< Contact centers of pressure
+  Eigen::VectorXd force_norms_;            //!< Norms of the contact forces
+  Eigen::VectorXd normal_norms_;           //!< Norms of the contact surface normals
+
+  boost::thread thread_;                                         //!< Background thread
+  boost::mutex queue_mutex_;                                     //!< Protects the pending message and snapshots
+  boost::condition_variable queue_condition_;                    //!< Wakes up the background thread
+  whole_body_state_msgs::WholeBodyState::ConstPtr pending_msg_;  //!< Latest submitted message
+  ProcessingParameters pending_params_;                          //!< Parameters of the latest submitted message
+  WholeBodyStateSnapshot work_snapshot_;                         //!< Snapshot written by the background thread
+  WholeBodyStateSnapshot ready_snapshot_;                        //!< Latest snapshot ready to be rendered
+  bool has_ready_snapshot_;                                      //!< Whether there is a snapshot ready to be rendered
+  bool stop_;                                                    //!< Requests the background thread to stop
+};
+
+}  // namespace whole_body_state_rviz_plugin
+
+#endif  // WHOLE_BODY_STATE_RVIZ_PLUGIN_WHOLE_BODY_STATE_PROCESSOR_H
@@ -10,11 +10,19 @@
 #define WHOLE_BODY_STATE_RVIZ_PLUGIN_WHOLE_BODY_TRAJECTORY_DISPLAY_H
 
 #include "whole_body_state_rviz_plugin/ArrowVisual.h"
-#include "whole_body_state_rviz_plugin/PointVisual.h"
+#include "whole_body_state_rviz_plugin/AxesListVisual.h"
+#include "whole_body_state_rviz_plugin/DisplaySettings.h"
+#include "whole_body_state_rviz_plugin/JointConfigurationMapper.h"
+#include "whole_body_state_rviz_plugin/LinkFrames.h"
+#include "whole_body_state_rviz_plugin/PointListVisual.h"
+#include "whole_body_state_rviz_plugin/RobotModelLoader.h"
+#include "whole_body_state_rviz_plugin/StageProfiler.h"
+#include "whole_body_state_rviz_plugin/TrajectorySeries.h"
+#include "whole_body_state_rviz_plugin/TransformCache.h"
+#include "whole_body_state_rviz_plugin/VisualPool.h"
 #include <pinocchio/multibody/data.hpp>
 #include <pinocchio/multibody/model.hpp>
 #include <rviz/message_filter_display.h>
-#include <rviz/ogre_helpers/axes.h>
 #include <rviz/ogre_helpers/billboard_line.h>
 #include <rviz/properties/color_property.h>
 #include <rviz/properties/enum_property.h>
@@ -35,7 +43,6 @@ class IntProperty;
 class EnumProperty;
 class BillboardLine;
 class VectorProperty;
-class Axes;
 
 }  // namespace rviz
 
@@ -97,11 +104,67 @@ class WholeBodyTrajectoryDisplay : public rviz::MessageFilterDisplay<whole_body_
   void updateContactEnable();
   void updateContactStyle();
   void updateContactLineProperties();
-  void pushBackCoMAxes(const Ogre::Vector3 &axes_position, const Ogre::Quaternion &axes_orientation);
-  void pushBackContactAxes(const Ogre::Vector3 &axes_position, const Ogre::Quaternion &axes_orientation);
+  void updateProfiling();
   /**@}*/
 
  private:
+  enum LineStyle { BILLBOARDS, LINES, POINTS };
+
+  /** @brief Appearance of a trajectory series, as set in the display properties */
+  struct SeriesSettings {
+    SeriesSettings()
+        : enable(true), style(BILLBOARDS), line_width(0.), axes_enable(true), axes_scale(0.), axes_max(0) {}
+
+    bool enable;              //!< Whether the series are displayed
+    LineStyle style;          //!< Line style
+    Ogre::ColourValue color;  //!< Line color and alpha
+    float line_width;         //!< Line width or point radius
+    bool axes_enable;         //!< Whether the axes are displayed
+    float axes_scale;         //!< Axes scale
+    std::size_t axes_max;     //!< Maximum number of axes per series
+  };
+
+  /**
+   * @brief Values of the display properties
+   * They are only written by the property slots, so the processing of a message never reads the property tree. The
+   * groups that changed since they were pushed to the visuals are flagged as dirty.
+   */
+  struct Settings {
+    /** @brief Groups of settings that are pushed to the visuals together */
+    enum Group {
+      FORCE_APPEARANCE = 1 << 0,
+      FORCE_GEOMETRY = 1 << 1,  //!< Geometry scaled by the target forces, which are processed again
+      COM_APPEARANCE = 1 << 2,
+      CONTACT_APPEARANCE = 1 << 3,
+      ALL_GROUPS = (1 << 4) - 1
+    };
+
+    Settings() : target_enable(true), dirty(ALL_GROUPS) {}
+
+    bool target_enable;             //!< Whether the target posture is displayed
+    Ogre::ColourValue force_color;  //!< Color and alpha of the target forces
+    ArrowSettings force_arrow;      //!< Geometry of the target force arrows
+    SeriesSettings com;             //!< Appearance of the CoM trajectory
+    SeriesSettings contact;         //!< Appearance of the contact trajectories
+    unsigned int dirty;             //!< Groups that changed since they were pushed to the visuals
+  };
+
+  /**
+   * @brief Geometry of a trajectory series, which is kept alive across messages
+   * Only the geometry of the current line style is created. It is rewritten in place when the knots change, and left
+   * untouched otherwise.
+   */
+  struct SeriesGeometry {
+    SeriesGeometry() : billboard_capacity(0) {}
+
+    TrajectorySeries knots;                                 //!< Knots displayed by the geometry
+    boost::shared_ptr<rviz::BillboardLine> billboard_line;  //!< Geometry of the billboards style
+    std::size_t billboard_capacity;                         //!< Number of points allocated by the billboard line
+    boost::shared_ptr<Ogre::ManualObject> manual_object;    //!< Geometry of the lines style
+    boost::shared_ptr<PointListVisual> points;              //!< Geometry of the points style
+    boost::shared_ptr<AxesListVisual> axes;                 //!< Axes sampled along the knots
+  };
+
   /**@{*/
   /** Process the trajectories */
   void processTargetPosture();
@@ -109,12 +172,54 @@ class WholeBodyTrajectoryDisplay : public rviz::MessageFilterDisplay<whole_body_
   void processContactTrajectory();
   /**@}*/
 
+  /**
+   * @brief Update the geometry of a trajectory series
+   * The knots are compared against the ones displayed by the geometry, and the geometry is updated only if they
+   * changed.
+   * @param geometry  Geometry of the series
+   * @param knots     New knots of the series, which are swapped with the displayed ones
+   * @param style     Line style
+   * @param color     Line color
+   * @param width     Line width or point radius
+   * @return True if the knots changed
+   */
+  bool updateSeriesGeometry(SeriesGeometry &geometry, TrajectorySeries &knots, LineStyle style,
+                            const Ogre::ColourValue &color, float width);
+
+  /**
+   * @brief Sample the axes of a trajectory series
+   * The axes are spaced according to their scale, and at most the maximum count of them is drawn.
+   * @param geometry  Geometry of the series
+   * @param enable    Whether the axes are displayed
+   * @param scale     Axes scale
+   * @param alpha     Axes alpha
+   * @param max_axes  Maximum number of axes
+   */
+  void updateSeriesAxes(SeriesGeometry &geometry, bool enable, float scale, float alpha, std::size_t max_axes);
+
+  /**
+   * @brief Push the appearance settings to the visuals
+   * The series drawn as lines are processed again, since their colors are stored in the vertices.
+   * @param groups  Appearance groups to push, see Settings::Group
+   */
+  void applySettings(unsigned int groups);
+
+  /**
+   * @brief Push the appearance settings of a trajectory series to its geometry
+   * @param geometry  Geometry of the series
+   * @param settings  Appearance of the series
+   */
+  void applySeriesSettings(SeriesGeometry &geometry, const SeriesSettings &settings);
+
   /** @brief Load the robot model */
   void loadRobotModel();
 
   /** @brief Clear the robot model */
   void clearRobotModel();
 
+  /** @brief Hand off the robot model once it was parsed in the background */
+  void handOffRobotModel();
+
   /** @brief Destroy all the objects for visualization */
   void destroyObjects();
 
@@ -124,6 +229,11 @@ class WholeBodyTrajectoryDisplay : public rviz::MessageFilterDisplay<whole_body_
   bool has_new_msg_;  ///< Callback sets this to tell our update function
                       ///< it needs to update the model
 
+  StageProfiler profiler_;          //!< Records the processing stages
+  TransformCache transform_cache_;  //!< Transforms of the message frame into the fixed frame, shared by the stages
+  Settings settings_;               //!< Values of the display properties
+  float status_elapsed_;            //!< Time elapsed since the transform and performance statuses were reported
+
   /**@{*/
   /** Properties to show on side panel */
   rviz::Property *target_category_;
@@ -134,17 +244,20 @@ class WholeBodyTrajectoryDisplay : public rviz::MessageFilterDisplay<whole_body_
   /**@{*/
   /** Object for visualization of the data */
   boost::shared_ptr<rviz::Robot> robot_;
-  boost::shared_ptr<Ogre::ManualObject> com_manual_object_;
-  boost::shared_ptr<rviz::BillboardLine> com_billboard_line_;
-  std::vector<boost::shared_ptr<PointVisual>> com_points_;
-  std::vector<boost::shared_ptr<rviz::Axes>> com_axes_;
-  std::vector<boost::shared_ptr<Ogre::ManualObject>> contact_manual_object_;
-  std::vector<boost::shared_ptr<rviz::BillboardLine>> contact_billboard_line_;
-  std::vector<std::vector<boost::shared_ptr<PointVisual>>> contact_points_;
-  std::vector<boost::shared_ptr<rviz::Axes>> contact_axes_;
-  std::vector<boost::shared_ptr<ArrowVisual>> force_visual_;
+  SeriesGeometry com_geometry_;
+  std::vector<SeriesGeometry> contact_geometry_;
+  VisualPool<ArrowVisual> force_visual_;
   /**@}*/
 
+  /**@{*/
+  /** Knots sampled from the last message, which are compared against the displayed ones */
+  TrajectorySeries com_knots_;
+  std::vector<TrajectorySeries> contact_knots_;
+  /**@}*/
+
+  /** @brief Axes sampled from a series, which are passed to its axes visual */
+  TrajectorySeries sampled_axes_;
+
   /**@{*/
   /** Property objects for user-editable properties */
   rviz::BoolProperty *target_enable_property_;
@@ -165,33 +278,29 @@ class WholeBodyTrajectoryDisplay : public rviz::MessageFilterDisplay<whole_body_
   rviz::FloatProperty *com_alpha_property_;
   rviz::FloatProperty *com_line_width_property_;
   rviz::FloatProperty *com_scale_property_;
+  rviz::IntProperty *com_axes_max_property_;
   rviz::BoolProperty *contact_enable_property_;
   rviz::EnumProperty *contact_style_property_;
   rviz::ColorProperty *contact_color_property_;
   rviz::FloatProperty *contact_alpha_property_;
   rviz::FloatProperty *contact_line_width_property_;
   rviz::FloatProperty *contact_scale_property_;
+  rviz::IntProperty *contact_axes_max_property_;
+  rviz::BoolProperty *profiling_enable_property_;
+  rviz::StringProperty *profiling_csv_property_;
   /**@}*/
 
   /**@{*/
   /** Robot variables */
   std::string robot_description_;
-  pinocchio::Model model_;
+  RobotModelLoader model_loader_;                    //!< Parses the robot description in the background
+  boost::shared_ptr<const pinocchio::Model> model_;  //!< Robot model, which is shared with the other displays
   pinocchio::Data data_;
+  JointConfigurationMapper joint_mapper_;            //!< Maps the message joints into the configuration vector
+  LinkFrames link_frames_;                           //!< Frames of the links drawn by the robot
+  LinkFrames::FramePlacements link_placements_;      //!< Placements of the link frames
   double weight_;
   /**@}*/
-
-  Ogre::Vector3 last_point_position_;
-  enum LineStyle { BILLBOARDS, LINES, POINTS };
-
-  /**@{*/
-  /** Flag that indicates if the category are enable */
-  bool target_enable_;
-  bool com_enable_;
-  bool com_axes_enable_;
-  bool contact_enable_;
-  bool contact_axes_enable_;
-  /**@}*/
 };
 
 }  // namespace whole_body_state_rviz_plugin
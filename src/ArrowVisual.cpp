@@ -72,4 +72,6 @@ void ArrowVisual::setProperties(float shaft_length, float shaft_diameter, float
   arrow_->set(shaft_length, shaft_diameter, head_length, head_diameter);
 }
 
+void ArrowVisual::setVisible(bool visible) { frame_node_->setVisible(visible); }
+
 }  // namespace whole_body_state_rviz_plugin
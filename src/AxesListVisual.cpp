@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <OgreManualObject.h>
+#include <OgreMaterialManager.h>
+#include <OgreSceneManager.h>
+#include <OgreSceneNode.h>
+#include <OgreTechnique.h>
+
+#include "whole_body_state_rviz_plugin/AxesListVisual.h"
+#include <sstream>
+
+namespace whole_body_state_rviz_plugin {
+
+AxesListVisual::AxesListVisual(Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent_node)
+    : mesh_initialized_(false), length_(1.), alpha_(1.) {
+  scene_manager_ = scene_manager;
+
+  // Ogre::SceneNode s form a tree, with each node storing the transform
+  // (position and orientation) of itself relative to its parent. Ogre does
+  // the math of combining those transforms when it is time to render. Here
+  // we create a node to store the pose of the frames' header frame relative
+  // to the RViz fixed frame.
+  frame_node_ = parent_node->createChildSceneNode();
+
+  // Initialization of the line list. It uses a transparent material without lighting, and the color is defined per
+  // vertex
+  static int count = 0;
+  std::stringstream ss;
+  ss << "AxesListVisualMaterial" << count++;
+  material_ =
+      Ogre::MaterialManager::getSingleton().create(ss.str(), Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+  material_->setReceiveShadows(false);
+  material_->getTechnique(0)->setLightingEnabled(false);
+  material_->getTechnique(0)->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
+  material_->getTechnique(0)->setDepthWriteEnabled(false);
+  mesh_ = scene_manager_->createManualObject();
+  mesh_->setDynamic(true);
+  frame_node_->attachObject(mesh_);
+}
+
+AxesListVisual::~AxesListVisual() {
+  // Delete the line list to make it disappear.
+  scene_manager_->destroyManualObject(mesh_);
+  Ogre::MaterialManager::getSingleton().remove(material_->getName());
+  // Destroy the frame node since we don't need it anymore.
+  scene_manager_->destroySceneNode(frame_node_);
+}
+
+void AxesListVisual::setAxes(const TrajectorySeries &axes) {
+  axes_ = axes;
+  updateMesh();
+}
+
+void AxesListVisual::setLength(float length) {
+  if (length != length_) {
+    length_ = length;
+    updateMesh();
+  }
+}
+
+void AxesListVisual::setAlpha(float alpha) {
+  if (alpha != alpha_) {
+    alpha_ = alpha;
+    updateMesh();
+  }
+}
+
+void AxesListVisual::setVisible(bool visible) { frame_node_->setVisible(visible); }
+
+std::size_t AxesListVisual::size() const { return axes_.size(); }
+
+void AxesListVisual::updateMesh() {
+  const std::size_t num_axes = axes_.size();
+  if (num_axes == 0) {
+    mesh_->setVisible(false);
+    return;
+  }
+
+  // The mesh section is created once and then updated in place
+  if (mesh_initialized_) {
+    mesh_->beginUpdate(0);
+  } else {
+    mesh_->estimateVertexCount(6 * num_axes);
+    mesh_->begin(material_->getName(), Ogre::RenderOperation::OT_LINE_LIST);
+    mesh_initialized_ = true;
+  }
+  // The x, y and z segments are red, green and blue, respectively
+  const Ogre::ColourValue colors[3] = {Ogre::ColourValue(1., 0., 0., alpha_), Ogre::ColourValue(0., 1., 0., alpha_),
+                                       Ogre::ColourValue(0., 0., 1., alpha_)};
+  computeAxesVertices(axes_, length_, vertices_);
+  for (std::size_t i = 0; i < num_axes; ++i) {
+    for (std::size_t j = 0; j < 6; ++j) {
+      const std::size_t k = 6 * i + j;
+      mesh_->position(vertices_(0, k), vertices_(1, k), vertices_(2, k));
+      mesh_->colour(colors[j / 2]);
+    }
+  }
+  mesh_->end();
+  mesh_->setVisible(true);
+}
+
+}  // namespace whole_body_state_rviz_plugin
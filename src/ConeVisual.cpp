@@ -6,8 +6,11 @@
 // All rights reserved.
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <OgreMaterial.h>
+#include <OgrePass.h>
 #include <OgreSceneManager.h>
 #include <OgreSceneNode.h>
+#include <OgreTechnique.h>
 #include <OgreVector3.h>
 
 #include <ros/console.h>
@@ -63,4 +66,10 @@ void ConeVisual::setProperties(float width, float length) {
   cone_->setOffset(Ogre::Vector3(0., -0.5, 0.));
 }
 
+void ConeVisual::setWireframe(bool wireframe) {
+  cone_->getMaterial()->getTechnique(0)->getPass(0)->setPolygonMode(wireframe ? Ogre::PM_WIREFRAME : Ogre::PM_SOLID);
+}
+
+void ConeVisual::setVisible(bool visible) { frame_node_->setVisible(visible); }
+
 }  // namespace whole_body_state_rviz_plugin
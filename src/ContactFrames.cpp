@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "whole_body_state_rviz_plugin/ContactFrames.h"
+#include <Eigen/Geometry>
+
+namespace whole_body_state_rviz_plugin {
+
+void ContactFrames::fill(const std::vector<whole_body_state_msgs::ContactState> &contacts) {
+  const std::size_t num_contacts = contacts.size();
+  positions.resize(3, num_contacts);
+  normals.resize(3, num_contacts);
+  forces.resize(3, num_contacts);
+  torques.resize(3, num_contacts);
+  friction_coefficients.resize(num_contacts);
+  status.resize(num_contacts);
+  for (std::size_t i = 0; i < num_contacts; ++i) {
+    const whole_body_state_msgs::ContactState &contact = contacts[i];
+    positions.col(i) << contact.pose.position.x, contact.pose.position.y, contact.pose.position.z;
+    normals.col(i) << contact.surface_normal.x, contact.surface_normal.y, contact.surface_normal.z;
+    forces.col(i) << contact.wrench.force.x, contact.wrench.force.y, contact.wrench.force.z;
+    torques.col(i) << contact.wrench.torque.x, contact.wrench.torque.y, contact.wrench.torque.z;
+    friction_coefficients(i) = contact.friction_coefficient;
+    status[i] =
+        (contact.status == contact.ACTIVE ? ACTIVE : 0) | (contact.type == contact.LOCOMOTION ? LOCOMOTION : 0);
+  }
+}
+
+void computeRotationsFromTwoVectors(const Eigen::Vector3d &reference, const Eigen::Matrix3Xd &directions,
+                                    Eigen::Matrix4Xd &quaternions) {
+  const Eigen::Index num_directions = directions.cols();
+  quaternions.resize(4, num_directions);
+  if (num_directions == 0) {
+    return;
+  }
+
+  // Normalizing the vectors, zero directions are kept as they are
+  const Eigen::Vector3d v0 = reference.normalized();
+  const Eigen::Array<double, 1, Eigen::Dynamic> norms = directions.colwise().norm().array();
+  const Eigen::Array<double, 3, Eigen::Dynamic> v1 =
+      directions.array().rowwise() / (norms > 0.).select(norms, 1.).eval();
+
+  // The rotation axis is v0 x v1 and the half angle follows from c = v0 . v1, as in setFromTwoVectors
+  const Eigen::Array<double, 1, Eigen::Dynamic> c = v0(0) * v1.row(0) + v0(1) * v1.row(1) + v0(2) * v1.row(2);
+  const Eigen::Array<double, 1, Eigen::Dynamic> s = ((1. + c) * 2.).sqrt();
+  quaternions.row(0) = (v0(1) * v1.row(2) - v0(2) * v1.row(1)) / s;
+  quaternions.row(1) = (v0(2) * v1.row(0) - v0(0) * v1.row(2)) / s;
+  quaternions.row(2) = (v0(0) * v1.row(1) - v0(1) * v1.row(0)) / s;
+  quaternions.row(3) = 0.5 * s;
+
+  // Nearly opposite vectors have an ill-defined axis, which is handled by Eigen
+  const double threshold = -1. + Eigen::NumTraits<double>::dummy_precision();
+  for (Eigen::Index i = 0; i < num_directions; ++i) {
+    if (c(i) < threshold) {
+      Eigen::Quaterniond q;
+      q.setFromTwoVectors(reference, directions.col(i));
+      quaternions.col(i) = q.coeffs();
+    }
+  }
+}
+
+void computeCentersOfPressure(const Eigen::Matrix3Xd &forces, const Eigen::Matrix3Xd &torques,
+                              Eigen::Matrix3Xd &cops) {
+  // NOTE: x component is negative due to right-hand rotation rule
+  cops.resize(3, forces.cols());
+  cops.row(0) = -torques.row(1).array() / forces.row(2).array();
+  cops.row(1) = torques.row(0).array() / forces.row(2).array();
+  cops.row(2).setZero();  // Origin of frame is already at contact position
+}
+
+}  // namespace whole_body_state_rviz_plugin
@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "whole_body_state_rviz_plugin/ConvexHull.h"
+#include <algorithm>
+
+namespace whole_body_state_rviz_plugin {
+
+namespace {
+
+// Cross product of the vectors o->a and o->b. It is positive if the turn o->a->b is counter-clockwise
+double cross(const Eigen::Vector2d &o, const Eigen::Vector2d &a, const Eigen::Vector2d &b) {
+  return (a(0) - o(0)) * (b(1) - o(1)) - (a(1) - o(1)) * (b(0) - o(0));
+}
+
+}  // namespace
+
+void computeConvexHull(const std::vector<Eigen::Vector2d> &points, std::vector<std::size_t> &hull) {
+  const std::size_t n = points.size();
+  hull.clear();
+  if (n == 0) {
+    return;
+  }
+
+  // Sorting the points lexicographically
+  std::vector<std::size_t> order(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&points](std::size_t a, std::size_t b) {
+    return points[a](0) < points[b](0) || (points[a](0) == points[b](0) && points[a](1) < points[b](1));
+  });
+
+  // Building the lower and upper chains
+  hull.resize(2 * n);
+  std::size_t k = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    while (k >= 2 && cross(points[hull[k - 2]], points[hull[k - 1]], points[order[i]]) <= 0.) --k;
+    hull[k++] = order[i];
+  }
+  for (std::size_t i = n - 1, t = k + 1; i > 0; --i) {
+    while (k >= t && cross(points[hull[k - 2]], points[hull[k - 1]], points[order[i - 1]]) <= 0.) --k;
+    hull[k++] = order[i - 1];
+  }
+
+  // The last point is equal to the first one
+  hull.resize(k > 1 ? k - 1 : k);
+  if (hull.size() == 2 && points[hull[0]] == points[hull[1]]) {
+    hull.resize(1);
+  }
+}
+
+}  // namespace whole_body_state_rviz_plugin
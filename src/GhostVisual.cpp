@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <OgreEntity.h>
+#include <OgreSceneManager.h>
+#include <OgreSceneNode.h>
+#include <rviz/robot/robot.h>
+#include <rviz/robot/robot_link.h>
+
+#include "whole_body_state_rviz_plugin/GhostVisual.h"
+
+namespace whole_body_state_rviz_plugin {
+
+GhostVisual::GhostVisual(Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent_node, const rviz::Robot &robot,
+                         const LinkFrames &link_frames, const Ogre::MaterialPtr &material)
+    : material_(material), visible_(false), visual_visible_(true), collision_visible_(false) {
+  scene_manager_ = scene_manager;
+  frame_node_ = parent_node->createChildSceneNode();
+  visual_node_ = frame_node_->createChildSceneNode();
+  collision_node_ = frame_node_->createChildSceneNode();
+
+  // Each link of the robot is copied below a node that is posed as its link frame. The links without frame are not
+  // posed by PinocchioLinkUpdater either, so they are skipped.
+  const rviz::Robot::M_NameToLink &links = robot.getLinks();
+  for (rviz::Robot::M_NameToLink::const_iterator it = links.begin(); it != links.end(); ++it) {
+    const std::size_t index = link_frames.getIndex(it->first);
+    if (index == link_frames.size()) {
+      continue;
+    }
+    Ogre::SceneNode *visual_link = visual_node_->createChildSceneNode();
+    copyNode(it->second->getVisualNode(), visual_link);
+    links_.push_back(visual_link);
+    link_indices_.push_back(index);
+    Ogre::SceneNode *collision_link = collision_node_->createChildSceneNode();
+    copyNode(it->second->getCollisionNode(), collision_link);
+    links_.push_back(collision_link);
+    link_indices_.push_back(index);
+  }
+  updateVisibility();
+}
+
+GhostVisual::~GhostVisual() {
+  for (std::size_t i = 0; i < entities_.size(); ++i) {
+    scene_manager_->destroyEntity(entities_[i]);
+  }
+  for (std::size_t i = nodes_.size(); i > 0; --i) {
+    scene_manager_->destroySceneNode(nodes_[i - 1]);
+  }
+  for (std::size_t i = 0; i < links_.size(); ++i) {
+    scene_manager_->destroySceneNode(links_[i]);
+  }
+  scene_manager_->destroySceneNode(visual_node_);
+  scene_manager_->destroySceneNode(collision_node_);
+  scene_manager_->destroySceneNode(frame_node_);
+}
+
+void GhostVisual::setPosture(const LinkFrames::FramePlacements &placements) {
+  for (std::size_t i = 0; i < links_.size(); ++i) {
+    const std::size_t index = link_indices_[i];
+    if (index >= placements.size()) {
+      continue;
+    }
+    const Eigen::Vector3d &translation = placements[index].translation();
+    const Eigen::Quaterniond quaternion(placements[index].rotation());
+    links_[i]->setPosition(Ogre::Vector3(translation[0], translation[1], translation[2]));
+    links_[i]->setOrientation(Ogre::Quaternion(quaternion.w(), quaternion.x(), quaternion.y(), quaternion.z()));
+  }
+}
+
+void GhostVisual::setFramePosition(const Ogre::Vector3 &position) { frame_node_->setPosition(position); }
+
+void GhostVisual::setFrameOrientation(const Ogre::Quaternion &orientation) {
+  frame_node_->setOrientation(orientation);
+}
+
+void GhostVisual::setVisible(bool visible) {
+  visible_ = visible;
+  updateVisibility();
+}
+
+void GhostVisual::setVisualVisible(bool visible) {
+  visual_visible_ = visible;
+  updateVisibility();
+}
+
+void GhostVisual::setCollisionVisible(bool visible) {
+  collision_visible_ = visible;
+  updateVisibility();
+}
+
+void GhostVisual::copyNode(Ogre::SceneNode *source, Ogre::SceneNode *target) {
+  if (!source) {
+    return;
+  }
+  // The entities are created from the meshes of the robot, which are already loaded and shared by the mesh manager
+  for (unsigned short i = 0; i < source->numAttachedObjects(); ++i) {
+    Ogre::MovableObject *object = source->getAttachedObject(i);
+    if (object->getMovableType() != Ogre::EntityFactory::FACTORY_TYPE_NAME) {
+      continue;
+    }
+    Ogre::Entity *entity = scene_manager_->createEntity(static_cast<Ogre::Entity *>(object)->getMesh());
+    entity->setMaterial(material_);
+    entity->setCastShadows(false);
+    target->attachObject(entity);
+    entities_.push_back(entity);
+  }
+  // The child nodes hold the origins and scales of the link geometries
+  for (unsigned short i = 0; i < source->numChildren(); ++i) {
+    Ogre::SceneNode *child = static_cast<Ogre::SceneNode *>(source->getChild(i));
+    Ogre::SceneNode *copy = target->createChildSceneNode(child->getPosition(), child->getOrientation());
+    copy->setScale(child->getScale());
+    nodes_.push_back(copy);
+    copyNode(child, copy);
+  }
+}
+
+void GhostVisual::updateVisibility() {
+  visual_node_->setVisible(visible_ && visual_visible_);
+  collision_node_->setVisible(visible_ && collision_visible_);
+}
+
+}  // namespace whole_body_state_rviz_plugin
@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "whole_body_state_rviz_plugin/JointConfigurationMapper.h"
+#include <boost/functional/hash.hpp>
+#include <cassert>
+#include <cmath>
+#include <pinocchio/algorithm/joint-configuration.hpp>
+
+namespace whole_body_state_rviz_plugin {
+
+// Maximum number of message layouts kept in the cache
+static const std::size_t kMaxCachedLayouts = 16;
+
+JointConfigurationMapper::JointConfigurationMapper() : last_layout_(nullptr), cache_hits_(0), cache_misses_(0) {}
+
+void JointConfigurationMapper::setModel(const pinocchio::Model &model) {
+  clear();
+  q_neutral_ = pinocchio::neutral(model);
+
+  // The first two joints are the universe and the free-flyer root joint
+  for (pinocchio::JointIndex i = 2; i < (pinocchio::JointIndex)model.njoints; ++i) {
+    const int nq = model.joints[i].nq();
+    const int nv = model.joints[i].nv();
+    JointType type = UNSUPPORTED;
+    if (nq == 1 && nv == 1) {
+      type = SCALAR;
+    } else if (nq == 2 && nv == 1) {
+      type = UNBOUNDED;
+    }
+    joint_slots_[model.names[i]] = JointSlot(model.joints[i].idx_q(), type);
+  }
+}
+
+void JointConfigurationMapper::clear() {
+  joint_slots_.clear();
+  layouts_.clear();
+  last_layout_ = nullptr;
+  q_neutral_.resize(0);
+  cache_hits_ = 0;
+  cache_misses_ = 0;
+}
+
+void JointConfigurationMapper::fillConfiguration(const whole_body_state_msgs::WholeBodyState &state,
+                                                 Eigen::Ref<Eigen::VectorXd> q) {
+  q = q_neutral_;
+  q(3) = state.centroidal.base_orientation.x;
+  q(4) = state.centroidal.base_orientation.y;
+  q(5) = state.centroidal.base_orientation.z;
+  q(6) = state.centroidal.base_orientation.w;
+
+  const std::vector<JointSlot> &layout = getLayout(state.joints);
+  const std::size_t n_joints = state.joints.size();
+  assert(layout.size() == n_joints);
+  for (std::size_t j = 0; j < n_joints; ++j) {
+    const JointSlot &slot = layout[j];
+    const double position = state.joints[j].position;
+    switch (slot.type) {
+      case SCALAR:
+        q(slot.idx_q) = position;
+        break;
+      case UNBOUNDED:
+        q(slot.idx_q) = std::cos(position);
+        q(slot.idx_q + 1) = std::sin(position);
+        break;
+      case UNSUPPORTED:
+        break;
+    }
+  }
+}
+
+std::size_t JointConfigurationMapper::getCacheHits() const { return cache_hits_; }
+
+std::size_t JointConfigurationMapper::getCacheMisses() const { return cache_misses_; }
+
+const std::vector<JointConfigurationMapper::JointSlot> &JointConfigurationMapper::getLayout(
+    const std::vector<whole_body_state_msgs::JointState> &joints) {
+  // The messages of a stream usually share the layout of the previous one
+  if (last_layout_ && matchesSampledNames(*last_layout_, joints)) {
+    ++cache_hits_;
+    return last_layout_->slots;
+  }
+
+  const std::size_t fingerprint = computeFingerprint(joints);
+  std::unordered_map<std::size_t, Layout>::const_iterator it = layouts_.find(fingerprint);
+  if (it != layouts_.end() && it->second.names.size() == joints.size()) {
+    // The names are compared as well, since two sequences can share a fingerprint
+    bool same_names = true;
+    for (std::size_t j = 0; j < joints.size() && same_names; ++j) {
+      same_names = it->second.names[j] == joints[j].name;
+    }
+    if (same_names) {
+      ++cache_hits_;
+      last_layout_ = &it->second;
+      return it->second.slots;
+    }
+  }
+
+  // Building the layout of this joint-name sequence, which replaces the one with the same fingerprint
+  ++cache_misses_;
+  if (it == layouts_.end() && layouts_.size() >= kMaxCachedLayouts) {
+    layouts_.clear();
+    last_layout_ = nullptr;
+  }
+  Layout &layout = layouts_[fingerprint];
+  layout.names.resize(joints.size());
+  layout.slots.assign(joints.size(), JointSlot());
+  for (std::size_t j = 0; j < joints.size(); ++j) {
+    layout.names[j] = joints[j].name;
+    std::unordered_map<std::string, JointSlot>::const_iterator slot = joint_slots_.find(joints[j].name);
+    if (slot != joint_slots_.end()) {
+      layout.slots[j] = slot->second;
+    }
+  }
+  last_layout_ = &layout;
+  return layout.slots;
+}
+
+std::size_t JointConfigurationMapper::computeFingerprint(
+    const std::vector<whole_body_state_msgs::JointState> &joints) {
+  std::size_t seed = joints.size();
+  for (std::size_t j = 0; j < joints.size(); ++j) {
+    boost::hash_combine(seed, joints[j].name);
+  }
+  return seed;
+}
+
+bool JointConfigurationMapper::matchesSampledNames(const Layout &layout,
+                                                   const std::vector<whole_body_state_msgs::JointState> &joints) {
+  const std::size_t n_joints = joints.size();
+  if (layout.names.size() != n_joints) {
+    return false;
+  }
+  if (n_joints == 0) {
+    return true;
+  }
+  const std::size_t samples[3] = {0, n_joints / 2, n_joints - 1};
+  for (std::size_t i = 0; i < 3; ++i) {
+    if (layout.names[samples[i]] != joints[samples[i]].name) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace whole_body_state_rviz_plugin
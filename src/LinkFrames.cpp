@@ -0,0 +1,47 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "whole_body_state_rviz_plugin/LinkFrames.h"
+#include <pinocchio/algorithm/frames.hpp>
+
+namespace whole_body_state_rviz_plugin {
+
+void LinkFrames::setModel(const pinocchio::Model &model) {
+  clear();
+  // The URDF parser adds a body frame per link, which has the name of the link
+  for (pinocchio::FrameIndex i = 0; i < model.frames.size(); ++i) {
+    const pinocchio::Frame &frame = model.frames[i];
+    if (frame.type == pinocchio::BODY && indices_.find(frame.name) == indices_.end()) {
+      indices_[frame.name] = frame_ids_.size();
+      frame_ids_.push_back(i);
+    }
+  }
+}
+
+void LinkFrames::clear() {
+  frame_ids_.clear();
+  indices_.clear();
+}
+
+std::size_t LinkFrames::getIndex(const std::string &link_name) const {
+  std::unordered_map<std::string, std::size_t>::const_iterator it = indices_.find(link_name);
+  if (it == indices_.end()) {
+    return frame_ids_.size();
+  }
+  return it->second;
+}
+
+void LinkFrames::computePlacements(const pinocchio::Model &model, pinocchio::Data &data,
+                                   FramePlacements &placements) const {
+  placements.resize(frame_ids_.size());
+  for (std::size_t i = 0; i < frame_ids_.size(); ++i) {
+    placements[i] = pinocchio::updateFramePlacement(model, data, frame_ids_[i]);
+  }
+}
+
+}  // namespace whole_body_state_rviz_plugin
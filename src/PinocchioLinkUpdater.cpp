@@ -13,23 +13,20 @@
 
 #include <OgreQuaternion.h>
 #include <OgreVector3.h>
-#include <pinocchio/algorithm/frames.hpp>
 
 namespace whole_body_state_rviz_plugin {
 
-PinocchioLinkUpdater::PinocchioLinkUpdater(pinocchio::Model &model, pinocchio::Data &data,
-                                           const Eigen::Ref<const Eigen::VectorXd> &q, const StatusCallback &status_cb)
-    : model_(model), data_(data), status_callback_(status_cb) {
-  pinocchio::framesForwardKinematics(model_, data_, q);
-}
+PinocchioLinkUpdater::PinocchioLinkUpdater(const LinkFrames &link_frames, const FramePlacements &frame_placements,
+                                           const StatusCallback &status_cb)
+    : link_frames_(link_frames), frame_placements_(frame_placements), status_callback_(status_cb) {}
 
 bool PinocchioLinkUpdater::getLinkTransforms(const std::string &link_name, Ogre::Vector3 &visual_position,
                                              Ogre::Quaternion &visual_orientation, Ogre::Vector3 &collision_position,
                                              Ogre::Quaternion &collision_orientation) const {
-  if (model_.existFrame(link_name)) {
-    pinocchio::FrameIndex frameId = model_.getFrameId(link_name);
-    const Eigen::Vector3d &translation = data_.oMf[frameId].translation();
-    Eigen::Quaterniond quaternion(data_.oMf[frameId].rotation());
+  const std::size_t index = link_frames_.getIndex(link_name);
+  if (index < link_frames_.size() && index < frame_placements_.size()) {
+    const Eigen::Vector3d &translation = frame_placements_[index].translation();
+    Eigen::Quaterniond quaternion(frame_placements_[index].rotation());
     Ogre::Vector3 position(translation[0], translation[1], translation[2]);
     Ogre::Quaternion orientation(quaternion.w(), quaternion.x(), quaternion.y(), quaternion.z());
 
@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <OgreManualObject.h>
+#include <OgreMaterialManager.h>
+#include <OgreSceneManager.h>
+#include <OgreSceneNode.h>
+#include <OgreTechnique.h>
+
+#include "whole_body_state_rviz_plugin/PointListVisual.h"
+#include <sstream>
+
+namespace whole_body_state_rviz_plugin {
+
+namespace {
+
+// Vertices of a unit icosahedron, which are also the vertex normals of the sphere
+const float kGoldenRatio = 1.618034f;
+const float kNorm = 1.902113f;  // sqrt(1 + kGoldenRatio^2)
+const float kA = 1.f / kNorm;
+const float kB = kGoldenRatio / kNorm;
+const std::size_t kNumSphereVertices = 12;
+const float kSphereVertices[kNumSphereVertices][3] = {
+    {-kA, kB, 0.f}, {kA, kB, 0.f}, {-kA, -kB, 0.f}, {kA, -kB, 0.f}, {0.f, -kA, kB}, {0.f, kA, kB},
+    {0.f, -kA, -kB}, {0.f, kA, -kB}, {kB, 0.f, -kA}, {kB, 0.f, kA}, {-kB, 0.f, -kA}, {-kB, 0.f, kA}};
+
+// Triangles of a unit icosahedron in counter-clockwise order
+const std::size_t kNumSphereTriangles = 20;
+const unsigned int kSphereTriangles[kNumSphereTriangles][3] = {
+    {0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11}, {1, 5, 9}, {5, 11, 4},
+    {11, 10, 2}, {10, 7, 6}, {7, 1, 8}, {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8},
+    {3, 8, 9}, {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}};
+
+}  // namespace
+
+PointListVisual::PointListVisual(Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent_node)
+    : mesh_initialized_(false), radius_(0.) {
+  scene_manager_ = scene_manager;
+
+  // Ogre::SceneNode s form a tree, with each node storing the transform
+  // (position and orientation) of itself relative to its parent. Ogre does
+  // the math of combining those transforms when it is time to render. Here
+  // we create a node to store the pose of the points' header frame relative
+  // to the RViz fixed frame.
+  frame_node_ = parent_node->createChildSceneNode();
+
+  // Initialization of the mesh. Its material is lit, and the ambient and diffuse colors are defined per vertex
+  static int count = 0;
+  std::stringstream ss;
+  ss << "PointListVisualMaterial" << count++;
+  material_ =
+      Ogre::MaterialManager::getSingleton().create(ss.str(), Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+  material_->setReceiveShadows(false);
+  material_->getTechnique(0)->setLightingEnabled(true);
+  material_->getTechnique(0)->getPass(0)->setVertexColourTracking(Ogre::TVC_AMBIENT | Ogre::TVC_DIFFUSE);
+  mesh_ = scene_manager_->createManualObject();
+  mesh_->setDynamic(true);
+  frame_node_->attachObject(mesh_);
+}
+
+PointListVisual::~PointListVisual() {
+  // Delete the mesh to make it disappear.
+  scene_manager_->destroyManualObject(mesh_);
+  Ogre::MaterialManager::getSingleton().remove(material_->getName());
+  // Destroy the frame node since we don't need it anymore.
+  scene_manager_->destroySceneNode(frame_node_);
+}
+
+void PointListVisual::setPoints(const std::vector<Eigen::Vector3d> &points) {
+  points_ = points;
+  updateMesh();
+}
+
+void PointListVisual::setFramePosition(const Ogre::Vector3 &position) { frame_node_->setPosition(position); }
+
+void PointListVisual::setFrameOrientation(const Ogre::Quaternion &orientation) {
+  frame_node_->setOrientation(orientation);
+}
+
+void PointListVisual::setColor(float r, float g, float b, float a) {
+  Ogre::ColourValue color(r, g, b, a);
+  if (color != color_) {
+    color_ = color;
+    // Transparent points do not write into the depth buffer, as done by rviz::Shape
+    if (a < 0.9998) {
+      material_->getTechnique(0)->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
+      material_->getTechnique(0)->setDepthWriteEnabled(false);
+    } else {
+      material_->getTechnique(0)->setSceneBlending(Ogre::SBT_REPLACE);
+      material_->getTechnique(0)->setDepthWriteEnabled(true);
+    }
+    updateMesh();
+  }
+}
+
+void PointListVisual::setRadius(float r) {
+  if (r != radius_) {
+    radius_ = r;
+    updateMesh();
+  }
+}
+
+void PointListVisual::setVisible(bool visible) { frame_node_->setVisible(visible); }
+
+std::size_t PointListVisual::size() const { return points_.size(); }
+
+void PointListVisual::updateMesh() {
+  const std::size_t num_points = points_.size();
+  if (num_points == 0) {
+    mesh_->setVisible(false);
+    return;
+  }
+
+  // The mesh section is created once and then updated in place
+  if (mesh_initialized_) {
+    mesh_->beginUpdate(0);
+  } else {
+    mesh_->estimateVertexCount(num_points * kNumSphereVertices);
+    mesh_->estimateIndexCount(num_points * kNumSphereTriangles * 3);
+    mesh_->begin(material_->getName(), Ogre::RenderOperation::OT_TRIANGLE_LIST);
+    mesh_initialized_ = true;
+  }
+  // The radius scales a unit-diameter sphere, as done for rviz::Shape in PointVisual
+  const float scale = 0.5f * radius_;
+  for (std::size_t i = 0; i < num_points; ++i) {
+    const Eigen::Vector3d &point = points_[i];
+    for (std::size_t j = 0; j < kNumSphereVertices; ++j) {
+      const float *v = kSphereVertices[j];
+      mesh_->position(point.x() + scale * v[0], point.y() + scale * v[1], point.z() + scale * v[2]);
+      mesh_->normal(v[0], v[1], v[2]);
+      mesh_->colour(color_);
+    }
+  }
+  for (std::size_t i = 0; i < num_points; ++i) {
+    const unsigned int offset = i * kNumSphereVertices;
+    for (std::size_t j = 0; j < kNumSphereTriangles; ++j) {
+      const unsigned int *t = kSphereTriangles[j];
+      mesh_->triangle(offset + t[0], offset + t[1], offset + t[2]);
+    }
+  }
+  mesh_->end();
+  mesh_->setVisible(true);
+}
+
+}  // namespace whole_body_state_rviz_plugin
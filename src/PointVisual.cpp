@@ -55,4 +55,6 @@ void PointVisual::setRadius(float r) {
   point_->setScale(scale);
 }
 
+void PointVisual::setVisible(bool visible) { frame_node_->setVisible(visible); }
+
 }  // namespace whole_body_state_rviz_plugin
@@ -6,16 +6,22 @@
 // All rights reserved.
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <OgreManualObject.h>
+#include <OgreMaterialManager.h>
 #include <OgreSceneManager.h>
 #include <OgreSceneNode.h>
+#include <OgreTechnique.h>
 #include <OgreVector3.h>
 
+#include "whole_body_state_rviz_plugin/ConvexHull.h"
 #include "whole_body_state_rviz_plugin/PolygonVisual.h"
-#include <rviz/ogre_helpers/line.h>
+#include <rviz/ogre_helpers/billboard_line.h>
+#include <sstream>
 
 namespace whole_body_state_rviz_plugin {
 
-PolygonVisual::PolygonVisual(Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent_node) {
+PolygonVisual::PolygonVisual(Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent_node)
+    : mesh_initialized_(false), line_capacity_(0) {
   scene_manager_ = scene_manager;
 
   // Ogre::SceneNode s form a tree, with each node storing the transform
@@ -25,86 +31,116 @@ PolygonVisual::PolygonVisual(Ogre::SceneManager *scene_manager, Ogre::SceneNode
   // to the RViz fixed frame.
   frame_node_ = parent_node->createChildSceneNode();
 
-  // Initialization of the mesh
-  mesh_.reset(new rviz::MeshShape(scene_manager, parent_node));
+  // Initialization of the outline
+  line_ = new rviz::BillboardLine(scene_manager_, frame_node_);
+  line_->setNumLines(1);
+
+  // Initialization of the mesh. It uses a transparent material without lighting, and the color is defined per
+  // vertex
+  static int count = 0;
+  std::stringstream ss;
+  ss << "PolygonVisualMaterial" << count++;
+  mesh_material_ =
+      Ogre::MaterialManager::getSingleton().create(ss.str(), Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+  mesh_material_->setReceiveShadows(false);
+  mesh_material_->setCullingMode(Ogre::CULL_NONE);
+  mesh_material_->getTechnique(0)->setLightingEnabled(false);
+  mesh_material_->getTechnique(0)->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
+  mesh_material_->getTechnique(0)->setDepthWriteEnabled(false);
+  mesh_ = scene_manager_->createManualObject();
+  mesh_->setDynamic(true);
+  frame_node_->attachObject(mesh_);
 }
 
 PolygonVisual::~PolygonVisual() {
   // Delete the line and mesh to make it disappear.
-  line_.clear();
-  mesh_->clear();
+  delete line_;
+  scene_manager_->destroyManualObject(mesh_);
+  Ogre::MaterialManager::getSingleton().remove(mesh_material_->getName());
   // Destroy the frame node since we don't need it anymore.
   scene_manager_->destroySceneNode(frame_node_);
 }
 
 void PolygonVisual::setVertices(std::vector<Ogre::Vector3> &vertices) {
-  // Getting the number of vertices
-  unsigned int num_vertex = vertices.size();
-
-  // Visualization of the lines
-  line_.clear();
-  unsigned int num_line = 0;
-  for (unsigned int i = 1; i < num_vertex; i++) num_line += num_vertex - i;
-  line_.resize(num_line);
-
-  unsigned int counter = 0;
-  unsigned int tree = num_vertex;
-  while (tree > 1) {
-    unsigned int current_it = num_vertex - tree;
-    for (unsigned int i = current_it; i < num_vertex - 1; i++) {
-      // We create the line object within the frame node so that we can
-      // set its position and direction relative to its header frame.
-      line_[counter].reset(new whole_body_state_rviz_plugin::LineVisual(scene_manager_, frame_node_));
-
-      line_[counter]->setArrow(vertices[current_it], vertices[i + 1]);
-
-      counter++;
-    }
-    tree--;
+  // Computing the convex hull of the vertices projected onto the ground
+  const std::size_t num_vertex = vertices.size();
+  projected_vertices_.resize(num_vertex);
+  for (std::size_t i = 0; i < num_vertex; ++i) {
+    projected_vertices_[i] = Eigen::Vector2d(vertices[i].x, vertices[i].y);
+  }
+  computeConvexHull(projected_vertices_, hull_indices_);
+  const std::size_t num_hull = hull_indices_.size();
+  hull_vertices_.resize(num_hull);
+  for (std::size_t i = 0; i < num_hull; ++i) {
+    hull_vertices_[i] = vertices[hull_indices_[i]];
   }
 
-  // Visualization of the mesh
-  if (num_vertex >= 3) {
-    mesh_->clear();
-    mesh_->estimateVertexCount(num_vertex);
-    mesh_->beginTriangles();
-
-    // Adding the vertices
-    Ogre::Vector3 normal(0., 0., 1.);
-    for (unsigned int i = 0; i < num_vertex; ++i) mesh_->addVertex(vertices[i], normal);
-
-    // Adding the actual triangle
-    for (unsigned int i = 0; i < num_vertex; i++) {
-      mesh_->addTriangle(i % num_vertex, (i + 1) % num_vertex, (i + 2) % num_vertex);
+  // Visualization of the outline as a closed line. Its buffers are reallocated only when the hull grows
+  line_->clear();
+  if (num_hull >= 2) {
+    if (num_hull + 1 > line_capacity_) {
+      line_capacity_ = num_hull + 1;
+      line_->setMaxPointsPerLine(line_capacity_);
+    }
+    for (std::size_t i = 0; i < num_hull; ++i) {
+      line_->addPoint(hull_vertices_[i]);
+    }
+    if (num_hull >= 3) {
+      line_->addPoint(hull_vertices_[0]);
     }
-    mesh_->endTriangles();
   }
-}
 
-void PolygonVisual::setFramePosition(const Ogre::Vector3 &position) {
-  frame_node_->setPosition(position);
-  mesh_->setPosition(position);
+  // Visualization of the mesh
+  updateMesh();
 }
 
+void PolygonVisual::setFramePosition(const Ogre::Vector3 &position) { frame_node_->setPosition(position); }
+
 void PolygonVisual::setFrameOrientation(const Ogre::Quaternion &orientation) {
   frame_node_->setOrientation(orientation);
-  mesh_->setOrientation(orientation);
 }
 
-void PolygonVisual::setLineColor(float r, float g, float b, float a) {
-  unsigned int num_line = line_.size();
-  for (unsigned int i = 0; i < num_line; ++i) {
-    line_[i]->setColor(r, g, b, a);
+void PolygonVisual::setLineColor(float r, float g, float b, float a) { line_->setColor(r, g, b, a); }
+
+void PolygonVisual::setMeshColor(float r, float g, float b, float a) {
+  Ogre::ColourValue color(r, g, b, a);
+  if (color != mesh_color_) {
+    mesh_color_ = color;
+    updateMesh();
   }
 }
 
-void PolygonVisual::setMeshColor(float r, float g, float b, float a) { mesh_->setColor(r, g, b, a); }
+void PolygonVisual::setLineRadius(float radius) { line_->setLineWidth(radius); }
+
+void PolygonVisual::setVisible(bool visible) { frame_node_->setVisible(visible); }
+
+void PolygonVisual::updateMesh() {
+  const std::size_t num_hull = hull_vertices_.size();
+  if (num_hull < 3) {
+    mesh_->setVisible(false);
+    return;
+  }
+
+  // The mesh section is created once and then updated in place
+  if (mesh_initialized_) {
+    mesh_->beginUpdate(0);
+  } else {
+    mesh_->estimateVertexCount(num_hull);
+    mesh_->estimateIndexCount(3 * (num_hull - 2));
+    mesh_->begin(mesh_material_->getName(), Ogre::RenderOperation::OT_TRIANGLE_LIST);
+    mesh_initialized_ = true;
+  }
+  for (std::size_t i = 0; i < num_hull; ++i) {
+    mesh_->position(hull_vertices_[i]);
+    mesh_->colour(mesh_color_);
+  }
 
-void PolygonVisual::setLineRadius(float radius) {
-  unsigned int num_line = line_.size();
-  for (unsigned int i = 0; i < num_line; ++i) {
-    line_[i]->setProperties(radius);
+  // Triangle fan of the convex hull
+  for (std::size_t i = 1; i + 1 < num_hull; ++i) {
+    mesh_->triangle(0, i, i + 1);
   }
+  mesh_->end();
+  mesh_->setVisible(true);
 }
 
 }  // namespace whole_body_state_rviz_plugin
@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "whole_body_state_rviz_plugin/RenderBudget.h"
+
+namespace whole_body_state_rviz_plugin {
+
+RenderBudget::RenderBudget(double hold_time)
+    : budget_(0.), hold_time_(hold_time), elapsed_(0.), cost_(0.), has_cost_(false), trigger_cost_(0.), level_(FULL) {}
+
+void RenderBudget::setBudget(double budget) {
+  budget_ = budget > 0. ? budget : 0.;
+  elapsed_ = 0.;
+  has_cost_ = false;
+  cost_ = 0.;
+  trigger_cost_ = 0.;
+  level_ = FULL;
+}
+
+void RenderBudget::recordCost(double cost) {
+  // The smoothing ignores the cost spikes of single frames, e.g. when the visuals are allocated
+  cost_ = has_cost_ ? 0.9 * cost_ + 0.1 * cost : cost;
+  has_cost_ = true;
+}
+
+bool RenderBudget::update(double dt) {
+  elapsed_ += dt;
+  if (budget_ == 0. || !has_cost_ || elapsed_ < hold_time_) {
+    return false;
+  }
+  if (cost_ > budget_ && level_ + 1 < NUM_LEVELS) {
+    level_ = static_cast<Level>(level_ + 1);
+    trigger_cost_ = cost_;
+  } else if (cost_ < 0.5 * budget_ && level_ > FULL) {
+    level_ = static_cast<Level>(level_ - 1);
+  } else {
+    return false;
+  }
+  elapsed_ = 0.;
+  return true;
+}
+
+const char *RenderBudget::getLevelName(Level level) {
+  switch (level) {
+    case FULL:
+      return "Full detail";
+    case SIMPLE_CONES:
+      return "Wireframe cones";
+    case MERGED_FORCES:
+      return "Merged contact forces";
+    case DECIMATED:
+      return "Decimated contact overlays";
+    default:
+      return "Unknown";
+  }
+}
+
+}  // namespace whole_body_state_rviz_plugin
@@ -0,0 +1,66 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "whole_body_state_rviz_plugin/RobotModelCache.h"
+#include <boost/functional/hash.hpp>
+#include <pinocchio/parsers/urdf.hpp>
+#include <stdexcept>
+
+namespace whole_body_state_rviz_plugin {
+
+RobotModelCache &RobotModelCache::getInstance() {
+  static RobotModelCache cache;
+  return cache;
+}
+
+RobotModelCache::RobotModelCache() {}
+
+bool RobotModelCache::getModel(const std::string &description, boost::shared_ptr<const urdf::Model> &urdf_model,
+                               boost::shared_ptr<const pinocchio::Model> &model, std::string &error) {
+  const std::size_t key = boost::hash<std::string>()(description);
+  boost::mutex::scoped_lock lock(mutex_);
+  boost::shared_ptr<const Entry> entry;
+  std::pair<EntryMap::iterator, EntryMap::iterator> range = entries_.equal_range(key);
+  for (EntryMap::iterator it = range.first; it != range.second;) {
+    boost::shared_ptr<const Entry> candidate = it->second.lock();
+    if (!candidate) {
+      // Releasing the entries of the models that are not used anymore
+      entries_.erase(it++);
+      continue;
+    }
+    if (candidate->description == description) {
+      entry = candidate;
+    }
+    ++it;
+  }
+
+  if (!entry) {
+    boost::shared_ptr<Entry> new_entry(new Entry());
+    new_entry->description = description;
+    if (!new_entry->urdf_model.initString(description)) {
+      error = "Failed to parse URDF model";
+      return false;
+    }
+    try {
+      pinocchio::urdf::buildModelFromXML(description, pinocchio::JointModelFreeFlyer(), new_entry->model);
+    } catch (const std::invalid_argument &e) {
+      error = "Failed to instantiate model: ";
+      error += e.what();
+      return false;
+    }
+    entries_.insert(std::make_pair(key, boost::weak_ptr<const Entry>(new_entry)));
+    entry = new_entry;
+  }
+
+  // The models alias the entry, so they keep it alive
+  urdf_model = boost::shared_ptr<const urdf::Model>(entry, &entry->urdf_model);
+  model = boost::shared_ptr<const pinocchio::Model>(entry, &entry->model);
+  return true;
+}
+
+}  // namespace whole_body_state_rviz_plugin
@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "whole_body_state_rviz_plugin/RobotModelLoader.h"
+#include "whole_body_state_rviz_plugin/RobotModelCache.h"
+
+namespace whole_body_state_rviz_plugin {
+
+RobotModelLoader::RobotModelLoader()
+    : has_pending_description_(false), request_(0), has_result_(false), stop_(false) {}
+
+RobotModelLoader::~RobotModelLoader() {
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    stop_ = true;
+  }
+  condition_.notify_one();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void RobotModelLoader::load(const std::string &description) {
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    pending_description_ = description;
+    has_pending_description_ = true;
+    ++request_;
+    has_result_ = false;
+    urdf_model_.reset();
+    model_.reset();
+  }
+  if (!thread_.joinable()) {
+    thread_ = boost::thread(&RobotModelLoader::run, this);
+  }
+  condition_.notify_one();
+}
+
+void RobotModelLoader::cancel() {
+  boost::mutex::scoped_lock lock(mutex_);
+  pending_description_.clear();
+  has_pending_description_ = false;
+  ++request_;
+  has_result_ = false;
+  urdf_model_.reset();
+  model_.reset();
+}
+
+bool RobotModelLoader::getModel(boost::shared_ptr<const urdf::Model> &urdf_model,
+                                boost::shared_ptr<const pinocchio::Model> &model, std::string &error) {
+  boost::mutex::scoped_lock lock(mutex_);
+  if (!has_result_) {
+    return false;
+  }
+  urdf_model.swap(urdf_model_);
+  model.swap(model_);
+  error.swap(error_);
+  urdf_model_.reset();
+  model_.reset();
+  has_result_ = false;
+  return true;
+}
+
+void RobotModelLoader::run() {
+  std::string description;
+  while (true) {
+    std::size_t request;
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      while (!stop_ && !has_pending_description_) {
+        condition_.wait(lock);
+      }
+      if (stop_) {
+        return;
+      }
+      description.swap(pending_description_);
+      has_pending_description_ = false;
+      request = request_;
+    }
+
+    // The parsing runs without holding the lock, so the GUI thread can request another description meanwhile
+    boost::shared_ptr<const urdf::Model> urdf_model;
+    boost::shared_ptr<const pinocchio::Model> model;
+    std::string error;
+    RobotModelCache::getInstance().getModel(description, urdf_model, model, error);
+
+    boost::mutex::scoped_lock lock(mutex_);
+    if (request == request_) {
+      urdf_model_ = urdf_model;
+      model_ = model;
+      error_ = error;
+      has_result_ = true;
+    }
+  }
+}
+
+}  // namespace whole_body_state_rviz_plugin
@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "whole_body_state_rviz_plugin/SnapshotBuffer.h"
+#include <algorithm>
+
+namespace whole_body_state_rviz_plugin {
+
+SnapshotBuffer::SnapshotBuffer(std::size_t capacity)
+    : snapshots_(std::max<std::size_t>(capacity, 2)), first_(0), size_(0), held_(false) {}
+
+void SnapshotBuffer::push(const WholeBodyStateSnapshot &snapshot) {
+  if (size_ != 0 && snapshot.stamp <= at(size_ - 1).stamp) {
+    clear();
+  }
+  if (size_ == snapshots_.size()) {
+    first_ = (first_ + 1) % snapshots_.size();
+    --size_;
+  }
+  snapshots_[(first_ + size_) % snapshots_.size()] = snapshot;
+  ++size_;
+  held_ = false;
+}
+
+bool SnapshotBuffer::sample(const ros::Time &time, WholeBodyStateSnapshot &snapshot) {
+  if (size_ == 0) {
+    return false;
+  }
+
+  // Discarding the snapshots that are older than the sampled interval
+  while (size_ >= 2 && at(1).stamp <= time) {
+    first_ = (first_ + 1) % snapshots_.size();
+    --size_;
+  }
+
+  // The time is clamped to the buffered interval, and the clamped snapshot is only returned once
+  const WholeBodyStateSnapshot &from = at(0);
+  if (size_ == 1 || time <= from.stamp) {
+    if (held_ && held_stamp_ == from.stamp) {
+      return false;
+    }
+    snapshot = from;
+    held_ = true;
+    held_stamp_ = from.stamp;
+    return true;
+  }
+  const WholeBodyStateSnapshot &to = at(1);
+  const double alpha = (time - from.stamp).toSec() / (to.stamp - from.stamp).toSec();
+  interpolate(from, to, alpha, snapshot);
+  snapshot.stamp = time;
+  held_ = false;
+  return true;
+}
+
+void SnapshotBuffer::clear() {
+  first_ = 0;
+  size_ = 0;
+  held_ = false;
+}
+
+void SnapshotBuffer::interpolate(const WholeBodyStateSnapshot &from, const WholeBodyStateSnapshot &to, double alpha,
+                                 WholeBodyStateSnapshot &snapshot) {
+  // The quantities that cannot be blended are taken from the nearest snapshot
+  snapshot = alpha < 0.5 ? from : to;
+  if (from.frame_id != to.frame_id) {
+    return;
+  }
+
+  // Link placements, which only change when the posture of the snapshots differs
+  if (from.has_robot && to.has_robot && from.posture_id != to.posture_id &&
+      from.frame_placements.size() == to.frame_placements.size()) {
+    for (std::size_t i = 0; i < from.frame_placements.size(); ++i) {
+      const pinocchio::SE3 &from_placement = from.frame_placements[i];
+      const pinocchio::SE3 &to_placement = to.frame_placements[i];
+      pinocchio::SE3 &placement = snapshot.frame_placements[i];
+      placement.translation() = (1. - alpha) * from_placement.translation() + alpha * to_placement.translation();
+      const Eigen::Quaterniond from_rotation(from_placement.rotation());
+      const Eigen::Quaterniond to_rotation(to_placement.rotation());
+      placement.rotation() = from_rotation.slerp(alpha, to_rotation).toRotationMatrix();
+    }
+    snapshot.posture_id = 0;
+  }
+
+  // Centroidal quantities
+  if (from.com_visible && to.com_visible) {
+    snapshot.com = (1. - alpha) * from.com + alpha * to.com;
+    snapshot.com_velocity = (1. - alpha) * from.com_velocity + alpha * to.com_velocity;
+    snapshot.com_velocity_orientation = from.com_velocity_orientation.slerp(alpha, to.com_velocity_orientation);
+  }
+  if (from.has_support && to.has_support) {
+    snapshot.zmp = (1. - alpha) * from.zmp + alpha * to.zmp;
+    snapshot.icp = (1. - alpha) * from.icp + alpha * to.icp;
+    snapshot.cmp = (1. - alpha) * from.cmp + alpha * to.cmp;
+  }
+  if (from.net_force_visible && to.net_force_visible) {
+    snapshot.net_force_position = (1. - alpha) * from.net_force_position + alpha * to.net_force_position;
+    snapshot.net_force_orientation = from.net_force_orientation.slerp(alpha, to.net_force_orientation);
+    snapshot.net_force_ratio = (1. - alpha) * from.net_force_ratio + alpha * to.net_force_ratio;
+  }
+
+  // Contact wrenches, which are blended only if the contacts are the same in both snapshots
+  if (from.contacts.size() != to.contacts.size()) {
+    return;
+  }
+  for (std::size_t i = 0; i < from.contacts.size(); ++i) {
+    const ContactSnapshot &from_contact = from.contacts[i];
+    const ContactSnapshot &to_contact = to.contacts[i];
+    ContactSnapshot &contact = snapshot.contacts[i];
+    contact.position = (1. - alpha) * from_contact.position + alpha * to_contact.position;
+    contact.orientation = from_contact.orientation.slerp(alpha, to_contact.orientation);
+    if (from_contact.cop_visible && to_contact.cop_visible) {
+      contact.cop = (1. - alpha) * from_contact.cop + alpha * to_contact.cop;
+    }
+    if (from_contact.grf_visible && to_contact.grf_visible) {
+      contact.force_orientation = from_contact.force_orientation.slerp(alpha, to_contact.force_orientation);
+      contact.force_ratio = (1. - alpha) * from_contact.force_ratio + alpha * to_contact.force_ratio;
+    }
+    if (from_contact.cone_visible && to_contact.cone_visible) {
+      contact.cone_orientation = from_contact.cone_orientation.slerp(alpha, to_contact.cone_orientation);
+    }
+  }
+}
+
+}  // namespace whole_body_state_rviz_plugin
@@ -0,0 +1,144 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "whole_body_state_rviz_plugin/StageProfiler.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace whole_body_state_rviz_plugin {
+
+StageProfiler::ScopedTimer::ScopedTimer(StageProfiler *profiler, Stage stage)
+    : profiler_(profiler != nullptr && profiler->isEnabled() ? profiler : nullptr), stage_(stage) {
+  if (profiler_ != nullptr) {
+    start_time_ = std::chrono::steady_clock::now();
+  }
+}
+
+StageProfiler::ScopedTimer::~ScopedTimer() { stop(); }
+
+void StageProfiler::ScopedTimer::stop() {
+  if (profiler_ != nullptr) {
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start_time_;
+    profiler_->record(stage_, duration.count());
+    profiler_ = nullptr;
+  }
+}
+
+StageProfiler::StageProfiler(std::size_t window) : enabled_(false), window_(std::max<std::size_t>(window, 1)) {}
+
+StageProfiler::~StageProfiler() { closeCsv(); }
+
+void StageProfiler::setEnabled(bool enabled) {
+  enabled_ = enabled;
+  if (!enabled) {
+    reset();
+  }
+}
+
+void StageProfiler::record(Stage stage, double duration) {
+  boost::mutex::scoped_lock lock(mutex_);
+  StageSamples &samples = stages_[stage];
+  if (samples.durations.size() < window_) {
+    samples.durations.push_back(duration);
+  } else {
+    samples.durations[samples.next] = duration;
+    samples.next = (samples.next + 1) % window_;
+  }
+}
+
+void StageProfiler::reset() {
+  boost::mutex::scoped_lock lock(mutex_);
+  for (std::size_t i = 0; i < NUM_STAGES; ++i) {
+    stages_[i].durations.clear();
+    stages_[i].next = 0;
+  }
+}
+
+bool StageProfiler::openCsv(const std::string &path) {
+  closeCsv();
+  csv_.open(path.c_str(), std::ios::out | std::ios::trunc);
+  if (!csv_.is_open()) {
+    return false;
+  }
+  csv_ << "time,stage,samples,mean_ms,p95_ms,max_ms" << std::endl;
+  return true;
+}
+
+void StageProfiler::closeCsv() {
+  if (csv_.is_open()) {
+    csv_.close();
+  }
+}
+
+bool StageProfiler::getStatistics(Stage stage, StageStatistics &statistics) const {
+  boost::mutex::scoped_lock lock(mutex_);
+  const std::vector<double> &durations = stages_[stage].durations;
+  statistics = StageStatistics();
+  if (durations.empty()) {
+    return false;
+  }
+  statistics.samples = durations.size();
+  sorted_ = durations;
+  const std::size_t p95_index = (95 * (statistics.samples - 1)) / 100;
+  std::nth_element(sorted_.begin(), sorted_.begin() + p95_index, sorted_.end());
+  statistics.p95 = sorted_[p95_index];
+  for (std::size_t i = 0; i < statistics.samples; ++i) {
+    statistics.mean += durations[i];
+    statistics.max = std::max(statistics.max, durations[i]);
+  }
+  statistics.mean /= statistics.samples;
+  return true;
+}
+
+std::string StageProfiler::report(double time) {
+  std::ostringstream summary;
+  summary << std::fixed << std::setprecision(3);
+  for (std::size_t i = 0; i < NUM_STAGES; ++i) {
+    const Stage stage = static_cast<Stage>(i);
+    StageStatistics statistics;
+    if (!getStatistics(stage, statistics)) {
+      continue;
+    }
+    if (summary.tellp() > 0) {
+      summary << "; ";
+    }
+    summary << getStageName(stage) << " " << 1e3 * statistics.mean << "/" << 1e3 * statistics.p95 << "/"
+            << 1e3 * statistics.max;
+    if (csv_.is_open()) {
+      csv_ << std::fixed << std::setprecision(6) << time << "," << getStageName(stage) << "," << statistics.samples
+           << "," << 1e3 * statistics.mean << "," << 1e3 * statistics.p95 << "," << 1e3 * statistics.max << "\n";
+    }
+  }
+  if (csv_.is_open()) {
+    csv_.flush();
+  }
+  if (summary.tellp() == 0) {
+    return "No samples";
+  }
+  return "mean/p95/max [ms]: " + summary.str();
+}
+
+const char *StageProfiler::getStageName(Stage stage) {
+  switch (stage) {
+    case TRANSFORM_LOOKUP:
+      return "transform";
+    case FORWARD_KINEMATICS:
+      return "fk_com";
+    case CONTACT_LOOP:
+      return "contacts";
+    case VISUAL_UPDATE:
+      return "visuals";
+    case POLYGON_BUILD:
+      return "polygon";
+    default:
+      return "unknown";
+  }
+}
+
+}  // namespace whole_body_state_rviz_plugin
@@ -0,0 +1,195 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <OgreCamera.h>
+#include <OgreHardwareBufferManager.h>
+#include <OgreMaterialManager.h>
+#include <OgreRoot.h>
+#include <OgreSceneManager.h>
+#include <OgreSceneNode.h>
+#include <OgreSimpleRenderable.h>
+#include <OgreTechnique.h>
+
+#include "whole_body_state_rviz_plugin/TrailVisual.h"
+#include <algorithm>
+#include <sstream>
+
+namespace whole_body_state_rviz_plugin {
+
+/**
+ * @brief Line list whose vertex buffer is written in place
+ * Its bounding box is infinite, so it does not need to be updated when the trail grows.
+ */
+class TrailVisual::Renderable : public Ogre::SimpleRenderable {
+ public:
+  explicit Renderable(std::size_t num_vertices) {
+    mRenderOp.operationType = Ogre::RenderOperation::OT_LINE_LIST;
+    mRenderOp.useIndexes = false;
+    mRenderOp.vertexData = new Ogre::VertexData;
+    mRenderOp.vertexData->vertexStart = 0;
+    mRenderOp.vertexData->vertexCount = num_vertices;
+    Ogre::VertexDeclaration *declaration = mRenderOp.vertexData->vertexDeclaration;
+    const std::size_t offset = declaration->addElement(0, 0, Ogre::VET_FLOAT3, Ogre::VES_POSITION).getSize();
+    declaration->addElement(0, offset, Ogre::VET_COLOUR, Ogre::VES_DIFFUSE);
+    buffer_ = Ogre::HardwareBufferManager::getSingleton().createVertexBuffer(
+        declaration->getVertexSize(0), num_vertices, Ogre::HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY);
+    mRenderOp.vertexData->vertexBufferBinding->setBinding(0, buffer_);
+    mBox.setInfinite();
+  }
+
+  ~Renderable() { delete mRenderOp.vertexData; }
+
+  Ogre::Real getSquaredViewDepth(const Ogre::Camera *camera) const override {
+    return getParentSceneNode()->getSquaredViewDepth(camera);
+  }
+
+  Ogre::Real getBoundingRadius() const override { return 0.; }
+
+  /** @brief Write a range of vertices into the vertex buffer */
+  void write(std::size_t offset, std::size_t length, const void *source) {
+    buffer_->writeData(offset, length, source);
+  }
+
+ private:
+  Ogre::HardwareVertexBufferSharedPtr buffer_;  //!< Vertex buffer of the line list
+};
+
+TrailVisual::TrailVisual(Ogre::SceneManager *scene_manager, Ogre::SceneNode *parent_node)
+    : line_(nullptr),
+      first_(0),
+      size_(0),
+      duration_(10.),
+      color_(0),
+      last_time_(0.),
+      has_last_point_(false) {
+  scene_manager_ = scene_manager;
+  frame_node_ = parent_node->createChildSceneNode();
+
+  // The material has no lighting, and the color is defined per vertex
+  static int count = 0;
+  std::stringstream ss;
+  ss << "TrailVisualMaterial" << count++;
+  material_ =
+      Ogre::MaterialManager::getSingleton().create(ss.str(), Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+  material_->setReceiveShadows(false);
+  material_->getTechnique(0)->setLightingEnabled(false);
+  material_->getTechnique(0)->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
+  material_->getTechnique(0)->setDepthWriteEnabled(false);
+  setColor(1., 1., 1., 1.);
+  setCapacity(1000);
+}
+
+TrailVisual::~TrailVisual() {
+  if (line_) {
+    frame_node_->detachObject(line_);
+    delete line_;
+  }
+  Ogre::MaterialManager::getSingleton().remove(material_->getName());
+  scene_manager_->destroySceneNode(frame_node_);
+}
+
+void TrailVisual::addPoint(const Ogre::Vector3 &point, double time) {
+  if (has_last_point_ && time < last_time_) {
+    clear();
+  }
+  if (has_last_point_ && point == last_point_) {
+    return;
+  }
+
+  // The new segment overwrites the oldest one when the ring buffer is full
+  if (has_last_point_) {
+    const std::size_t capacity = times_.size();
+    const std::size_t index = (first_ + size_) % capacity;
+    if (size_ == capacity) {
+      first_ = (first_ + 1) % capacity;
+    } else {
+      ++size_;
+    }
+    Vertex &from = vertices_[2 * index];
+    Vertex &to = vertices_[2 * index + 1];
+    from.x = last_point_.x;
+    from.y = last_point_.y;
+    from.z = last_point_.z;
+    from.color = color_;
+    to.x = point.x;
+    to.y = point.y;
+    to.z = point.z;
+    to.color = color_;
+    times_[index] = time;
+    upload(index, 1);
+  }
+  last_point_ = point;
+  last_time_ = time;
+  has_last_point_ = true;
+  expire(time);
+}
+
+void TrailVisual::clear() {
+  const Vertex empty = {0.f, 0.f, 0.f, 0};
+  std::fill(vertices_.begin(), vertices_.end(), empty);
+  upload(0, times_.size());
+  first_ = 0;
+  size_ = 0;
+  has_last_point_ = false;
+}
+
+void TrailVisual::setCapacity(std::size_t capacity) {
+  capacity = std::max<std::size_t>(capacity, 1);
+  if (line_ && capacity == times_.size()) {
+    return;
+  }
+  if (line_) {
+    frame_node_->detachObject(line_);
+    delete line_;
+  }
+  line_ = new Renderable(2 * capacity);
+  line_->setMaterial(material_->getName());
+  line_->setCastShadows(false);
+  frame_node_->attachObject(line_);
+  vertices_.resize(2 * capacity);
+  times_.assign(capacity, 0.);
+  clear();
+}
+
+void TrailVisual::setColor(float r, float g, float b, float a) {
+  uint32_t color;
+  Ogre::Root::getSingleton().convertColourValue(Ogre::ColourValue(r, g, b, a), &color);
+  if (color == color_) {
+    return;
+  }
+  color_ = color;
+  for (std::size_t i = 0; i < size_; ++i) {
+    const std::size_t index = (first_ + i) % times_.size();
+    vertices_[2 * index].color = color_;
+    vertices_[2 * index + 1].color = color_;
+  }
+  upload(0, times_.size());
+}
+
+void TrailVisual::setVisible(bool visible) { frame_node_->setVisible(visible); }
+
+void TrailVisual::expire(double time) {
+  // The expired segments are collapsed into transparent points, so the vertex buffer keeps its size
+  while (size_ != 0 && times_[first_] < time - duration_) {
+    Vertex &from = vertices_[2 * first_];
+    from.color = 0;
+    vertices_[2 * first_ + 1] = from;
+    upload(first_, 1);
+    first_ = (first_ + 1) % times_.size();
+    --size_;
+  }
+}
+
+void TrailVisual::upload(std::size_t first, std::size_t n) {
+  if (!line_ || n == 0) {
+    return;
+  }
+  line_->write(2 * first * sizeof(Vertex), 2 * n * sizeof(Vertex), &vertices_[2 * first]);
+}
+
+}  // namespace whole_body_state_rviz_plugin
@@ -0,0 +1,181 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "whole_body_state_rviz_plugin/TrajectorySeries.h"
+#include <iostream>
+#include <map>
+
+namespace whole_body_state_rviz_plugin {
+
+namespace {
+
+/**
+ * @brief Append a knot expressed in the message frame to a series
+ * @param knot_position     Knot position in the message frame
+ * @param knot_orientation  Knot orientation in the message frame
+ * @param position          Position of the message frame in the fixed frame
+ * @param orientation       Orientation of the message frame in the fixed frame
+ * @param knots             Series
+ */
+void appendKnot(const Eigen::Vector3d &knot_position, const Eigen::Quaterniond &knot_orientation,
+                const Eigen::Vector3d &position, const Eigen::Quaterniond &orientation, TrajectorySeries &knots) {
+  knots.positions.push_back(orientation * knot_position + position);
+  knots.orientations.push_back(knot_orientation * orientation);
+}
+
+}  // namespace
+
+bool TrajectorySeries::operator==(const TrajectorySeries &other) const {
+  const std::size_t n_points = size();
+  if (n_points != other.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < n_points; ++i) {
+    if (positions[i] != other.positions[i] || orientations[i].coeffs() != other.orientations[i].coeffs()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void sampleCoMTrajectory(const std::vector<whole_body_state_msgs::WholeBodyState> &trajectory,
+                         const Eigen::Vector3d &position, const Eigen::Quaterniond &orientation,
+                         TrajectorySeries &knots) {
+  const std::size_t n_points = trajectory.size();
+  knots.clear();
+  for (std::size_t i = 0; i < n_points; ++i) {
+    const whole_body_state_msgs::WholeBodyState &state = trajectory[i];
+    // Obtaining the CoM position and the base orientation
+    Eigen::Vector3d com_position(state.centroidal.com_position.x, state.centroidal.com_position.y,
+                                 state.centroidal.com_position.z);
+    Eigen::Quaterniond base_orientation(state.centroidal.base_orientation.w, state.centroidal.base_orientation.x,
+                                        state.centroidal.base_orientation.y, state.centroidal.base_orientation.z);
+    // sanity checks
+    if (!com_position.allFinite()) {
+      std::cerr << "CoM position is not finite, resetting to zero" << std::endl;
+      com_position.setZero();
+    }
+    if (!base_orientation.coeffs().allFinite()) {
+      std::cerr << "Body orientation is not finite, resetting to [0 0 0 1]" << std::endl;
+      base_orientation.setIdentity();
+    }
+    appendKnot(com_position, base_orientation, position, orientation, knots);
+  }
+}
+
+void sampleContactTrajectories(const std::vector<whole_body_state_msgs::WholeBodyState> &trajectory,
+                               const Eigen::Vector3d &position, const Eigen::Quaterniond &orientation,
+                               std::vector<TrajectorySeries> &knots) {
+  // Getting the number of contact trajectories
+  const std::size_t n_points = trajectory.size();
+  std::size_t n_traj = 0;
+  std::map<std::string, std::size_t> contact_traj_id;
+  for (std::size_t i = 0; i < n_points; ++i) {
+    const whole_body_state_msgs::WholeBodyState &state = trajectory[i];
+    std::size_t n_contacts = state.contacts.size();
+    for (std::size_t k = 0; k < n_contacts; ++k) {
+      const whole_body_state_msgs::ContactState &contact = state.contacts[k];
+      if (contact_traj_id.find(contact.name) == contact_traj_id.end()) {  // a new swing trajectory
+        contact_traj_id[contact.name] = n_traj;
+        // Incrementing the counter (id) of swing trajectories
+        ++n_traj;
+      }
+    }
+  }
+
+  // Sampling the different end-effector trajectories in the fixed frame
+  contact_traj_id.clear();
+  std::map<std::size_t, std::size_t> contact_vec_id;
+  knots.resize(n_traj);
+  for (std::size_t i = 0; i < n_traj; ++i) {
+    knots[i].clear();
+  }
+  std::size_t traj_id = 0;
+  for (std::size_t i = 0; i < n_points; ++i) {
+    const whole_body_state_msgs::WholeBodyState &state = trajectory[i];
+    std::size_t n_contacts = state.contacts.size();
+    for (std::size_t k = 0; k < n_contacts; ++k) {
+      const whole_body_state_msgs::ContactState &contact = state.contacts[k];
+      if (contact_traj_id.find(contact.name) == contact_traj_id.end()) {  // a new swing trajectory
+        contact_traj_id[contact.name] = traj_id;
+        contact_vec_id[traj_id] = k;
+        // Incrementing the counter (id) of swing trajectories
+        ++traj_id;
+      } else {
+        std::size_t swing_idx = contact_traj_id.find(contact.name)->second;
+        if (k != contact_vec_id.find(swing_idx)->second) {  // change the vector index
+          contact_vec_id[swing_idx] = k;
+        }
+      }
+    }
+    // Adding the contact points for the current swing trajectories
+    for (std::map<std::string, std::size_t>::iterator traj_it = contact_traj_id.begin();
+         traj_it != contact_traj_id.end(); ++traj_it) {
+      std::size_t traj_id = traj_it->second;
+      std::size_t id = contact_vec_id.find(traj_id)->second;
+      if (id < n_contacts) {
+        const whole_body_state_msgs::ContactState &contact = state.contacts[id];
+        Eigen::Vector3d contact_position(contact.pose.position.x, contact.pose.position.y, contact.pose.position.z);
+        Eigen::Quaterniond contact_orientation(contact.pose.orientation.w, contact.pose.orientation.x,
+                                               contact.pose.orientation.y, contact.pose.orientation.z);
+        // sanity check orientation
+        if (!contact_position.allFinite()) {
+          std::cerr << "Contact trajectory is not finite, resetting to zero!" << std::endl;
+          contact_position.setZero();
+        }
+        if (!contact_orientation.coeffs().allFinite()) {
+          std::cerr << "Contact orientation is not finite, resetting to [0 0 0 1]" << std::endl;
+          contact_orientation.setIdentity();
+        }
+        appendKnot(contact_position, contact_orientation, position, orientation, knots[traj_id]);
+      }
+    }
+  }
+}
+
+void sampleAxes(const TrajectorySeries &knots, double scale, std::size_t max_axes, TrajectorySeries &axes) {
+  // Adding the frames with a distance from the last one of the same series
+  const std::size_t n_points = knots.size();
+  const double min_sq_distance = scale * scale * 0.0032;
+  axes.clear();
+  for (std::size_t i = 0; i < n_points; ++i) {
+    const Eigen::Vector3d &axes_position = knots.positions[i];
+    if (axes.positions.empty() || (axes_position - axes.positions.back()).squaredNorm() >= min_sq_distance) {
+      axes.positions.push_back(axes_position);
+      axes.orientations.push_back(knots.orientations[i]);
+    }
+  }
+
+  // Keeping an evenly spaced subset of the frames when they exceed the budget
+  const std::size_t n_sampled = axes.size();
+  if (n_sampled > max_axes) {
+    for (std::size_t i = 0; i < max_axes; ++i) {
+      const std::size_t k = i * n_sampled / max_axes;
+      axes.positions[i] = axes.positions[k];
+      axes.orientations[i] = axes.orientations[k];
+    }
+    axes.positions.resize(max_axes);
+    axes.orientations.resize(max_axes);
+  }
+}
+
+void computeAxesVertices(const TrajectorySeries &axes, double length, Eigen::Matrix3Xd &vertices) {
+  const std::size_t n_axes = axes.size();
+  vertices.resize(3, 6 * n_axes);
+  for (std::size_t i = 0; i < n_axes; ++i) {
+    // The columns of the rotation matrix are the directions of the axes
+    const Eigen::Vector3d &origin = axes.positions[i];
+    const Eigen::Matrix3d tips = length * axes.orientations[i].toRotationMatrix();
+    for (std::size_t j = 0; j < 3; ++j) {
+      vertices.col(6 * i + 2 * j) = origin;
+      vertices.col(6 * i + 2 * j + 1) = origin + tips.col(j);
+    }
+  }
+}
+
+}  // namespace whole_body_state_rviz_plugin
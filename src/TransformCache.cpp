@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "whole_body_state_rviz_plugin/TransformCache.h"
+#include <rviz/frame_manager.h>
+#include <algorithm>
+
+namespace whole_body_state_rviz_plugin {
+
+TransformCache::TransformCache(std::size_t capacity)
+    : capacity_(std::max<std::size_t>(capacity, 1)), next_(0), hits_(0), misses_(0) {
+  entries_.reserve(capacity_);
+}
+
+bool TransformCache::getTransform(rviz::FrameManager *frame_manager, const std::string &frame_id,
+                                  const ros::Time &stamp, Ogre::Vector3 &position, Ogre::Quaternion &orientation) {
+  const std::string &fixed_frame = frame_manager->getFixedFrame();
+  for (std::size_t i = 0; i < entries_.size(); ++i) {
+    const Entry &entry = entries_[i];
+    if (entry.stamp == stamp && entry.frame_id == frame_id && entry.fixed_frame == fixed_frame) {
+      position = entry.position;
+      orientation = entry.orientation;
+      ++hits_;
+      return true;
+    }
+  }
+
+  ++misses_;
+  if (!frame_manager->getTransform(frame_id, stamp, position, orientation)) {
+    return false;
+  }
+  if (entries_.size() < capacity_) {
+    entries_.push_back(Entry());
+    next_ = entries_.size() - 1;
+  }
+  Entry &entry = entries_[next_];
+  entry.frame_id = frame_id;
+  entry.stamp = stamp;
+  entry.fixed_frame = fixed_frame;
+  entry.position = position;
+  entry.orientation = orientation;
+  next_ = (next_ + 1) % capacity_;
+  return true;
+}
+
+void TransformCache::clear() {
+  entries_.clear();
+  next_ = 0;
+}
+
+void TransformCache::expireLatest() {
+  for (std::size_t i = 0; i < entries_.size();) {
+    if (entries_[i].stamp.isZero()) {
+      entries_[i] = entries_.back();
+      entries_.pop_back();
+    } else {
+      ++i;
+    }
+  }
+  next_ = entries_.size() % capacity_;
+}
+
+}  // namespace whole_body_state_rviz_plugin
@@ -10,9 +10,12 @@
 #include "whole_body_state_rviz_plugin/WholeBodyStateDisplay.h"
 #include "whole_body_state_rviz_plugin/PinocchioLinkUpdater.h"
 #include <Eigen/Dense>
+#include <OgreMaterialManager.h>
+#include <OgreTechnique.h>
 #include <QTimer>
-#include <pinocchio/algorithm/center-of-mass.hpp>
-#include <pinocchio/parsers/urdf.hpp>
+#include <algorithm>
+#include <limits>
+#include <sstream>
 
 using namespace rviz;
 
@@ -23,29 +26,71 @@ void linkUpdaterStatusFunction(rviz::StatusLevel level, const std::string &link_
   display->setStatus(level, QString::fromStdString(link_name), QString::fromStdString(text));
 }
 
+static void setPointAppearance(PointVisual &visual, const PointSettings &settings) {
+  visual.setColor(settings.color.r, settings.color.g, settings.color.b, settings.color.a);
+  visual.setRadius(settings.radius);
+}
+
+static void setTrailAppearance(TrailVisual &trail, const PointSettings &settings) {
+  trail.setColor(settings.color.r, settings.color.g, settings.color.b, settings.color.a);
+}
+
+static void extendTrail(TrailVisual &trail, bool visible, const Ogre::Vector3 &point, const Ogre::SceneNode &frame,
+                        double time) {
+  // A hidden point breaks the trail, so it is not connected to the next visible one. The trails are kept in the fixed
+  // frame, so each point is expressed with the transform that its snapshot was posed with.
+  if (visible) {
+    trail.addPoint(frame.getOrientation() * point + frame.getPosition(), time);
+  } else {
+    trail.breakLine();
+  }
+}
+
+static double getSnapshotTime(const WholeBodyStateSnapshot &snapshot) {
+  return snapshot.stamp.isZero() ? ros::Time::now().toSec() : snapshot.stamp.toSec();
+}
+
+WholeBodyStateDisplay::Settings::Settings()
+    : robot_enable(true),
+      robot_visual_enable(true),
+      robot_collision_enable(false),
+      posture_tolerance(0.),
+      track_transform(true),
+      interpolation_delay(0.),
+      com_enable(true),
+      com_real(true),
+      zmp_enable(true),
+      use_contact_status_in_zmp(true),
+      cop_enable(true),
+      use_contact_status_in_cop(true),
+      icp_enable(true),
+      cmp_enable(true),
+      grf_enable(true),
+      use_contact_status_in_grf(true),
+      grf_locate_at_cop(false),
+      support_enable(true),
+      use_contact_status_in_support(true),
+      support_line_radius(0.),
+      force_threshold(0.),
+      torque_threshold(0.),
+      cone_enable(true),
+      use_contact_status_in_friction_cone(true),
+      friction_cone_locate_at_cop(false),
+      cone_length(0.),
+      trail_enable(false),
+      trail_duration(0.),
+      trail_capacity(0),
+      ghost_enable(false),
+      ghost_count(1),
+      ghost_spacing(0.),
+      ghost_alpha(0.),
+      dirty(ALL_GROUPS) {}
+
 WholeBodyStateDisplay::WholeBodyStateDisplay()
-    : has_new_msg_(false),
-      initialized_model_(false),
-      force_threshold_(0.),
-      torque_threshold_(0.),
-      use_contact_status_in_zmp_(true),
-      use_contact_status_in_cop_(true),
-      use_contact_status_in_grf_(true),
-      use_contact_status_in_support_(true),
-      use_contact_status_in_friction_cone_(true),
-      grf_locate_at_cop_(false),
-      friction_cone_locate_at_cop_(false),
-      weight_(0.),
-      gravity_(9.81),
-      com_real_(true),
-      com_enable_(true),
-      zmp_enable_(true),
-      cop_enable_(true),
-      icp_enable_(true),
-      cmp_enable_(true),
-      grf_enable_(true),
-      support_enable_(true),
-      cone_enable_(true) {
+    : processed_messages_(0),
+      status_elapsed_(0.),
+      last_visual_allocations_(std::numeric_limits<std::size_t>::max()),
+      initialized_model_(false) {
   // Category Groups
   robot_category_ = new rviz::Property("Robot", QVariant(), "", this);
   com_category_ = new rviz::Property("Center Of Mass", QVariant(), "", this);
@@ -56,6 +101,64 @@ WholeBodyStateDisplay::WholeBodyStateDisplay()
   grf_category_ = new rviz::Property("Contact Forces", QVariant(), "", this);
   support_category_ = new rviz::Property("Support Region", QVariant(), "", this);
   friction_category_ = new rviz::Property("Friction Cone", QVariant(), "", this);
+  trail_category_ = new rviz::Property("Trails", QVariant(), "", this);
+  ghost_category_ = new rviz::Property("Ghosts", QVariant(), "", this);
+
+  // Input properties
+  input_policy_property_ = new EnumProperty("Input Policy", "All",
+                                            "Policy to decimate the incoming messages before they are transformed and "
+                                            "processed. 'Latest Only' keeps the latest message per render frame.",
+                                            this, SLOT(updateInputPolicy()), this);
+  input_policy_property_->addOption("All", InputFilter::ALL);
+  input_policy_property_->addOption("Latest Only", InputFilter::LATEST_ONLY);
+  input_policy_property_->addOption("Max Rate", InputFilter::MAX_RATE);
+  input_policy_property_->addOption("Keep Every Nth", InputFilter::KEEP_EVERY_NTH);
+  input_max_rate_property_ = new FloatProperty("Max Rate", 60., "Maximum rate, in Hz, of the processed messages.",
+                                               input_policy_property_, SLOT(updateInputPolicy()), this);
+  input_max_rate_property_->setMin(0.1);
+  input_keep_every_property_ = new IntProperty("Keep Every", 10, "Number of received messages per processed one.",
+                                               input_policy_property_, SLOT(updateInputPolicy()), this);
+  input_keep_every_property_->setMin(1);
+
+  // Profiling properties
+  profiling_enable_property_ =
+      new BoolProperty("Profiling", false, "Report the time spent in each processing stage as a status.", this,
+                       SLOT(updateProfiling()), this);
+  profiling_csv_property_ = new StringProperty("CSV File", "",
+                                               "File where the statistics of the processing stages are dumped every "
+                                               "second. Nothing is dumped if it is empty.",
+                                               profiling_enable_property_, SLOT(updateProfiling()), this);
+
+  // Transform properties
+  track_transform_property_ =
+      new BoolProperty("Track Transform", true,
+                       "Pose the visuals every frame with the latest transform of the message frame, so they follow "
+                       "a moving fixed frame between messages. Otherwise, or when the messages are interpolated, the "
+                       "transform at the message stamp is used.",
+                       this, SLOT(updateTrackTransform()), this);
+  interpolation_delay_property_ =
+      new FloatProperty("Interpolation Delay", 0.,
+                        "Delay in seconds at which the robot is displayed. The latest messages are buffered, and the "
+                        "displayed state is interpolated between them at every frame. It should exceed the message "
+                        "period plus latency. Zero displays each message as it arrives.",
+                        this, SLOT(updateInterpolationDelay()), this);
+  interpolation_delay_property_->setMin(0.);
+
+  // Render budget properties
+  render_budget_property_ =
+      new FloatProperty("Render Budget", 0.,
+                        "Time in milliseconds per frame for applying the messages to the visuals. When it is "
+                        "exceeded, the friction cones are drawn as wireframes, the contact forces are merged into the "
+                        "net force, and then the contact overlays are updated every other message. Zero disables it.",
+                        this, SLOT(updateRenderBudget()), this);
+  render_budget_property_->setMin(0.);
+
+  // Multi-robot properties
+  additional_topics_property_ =
+      new StringProperty("Additional Topics", "",
+                         "Space-separated list of topics of other robots with the same robot description. Their "
+                         "messages follow the input policy, and each robot is processed in parallel.",
+                         this, SLOT(updateAdditionalTopics()), this);
 
   // Robot properties
   robot_enable_property_ = new BoolProperty("Enable", true, "Enable/disable the target display", robot_category_,
@@ -73,6 +176,11 @@ WholeBodyStateDisplay::WholeBodyStateDisplay()
                                             robot_category_, SLOT(updateRobotAlpha()), this);
   robot_alpha_property_->setMin(0.0);
   robot_alpha_property_->setMax(1.0);
+  robot_posture_tolerance_property_ =
+      new FloatProperty("Posture Tolerance", 1e-4,
+                        "Largest change of the joint positions and base pose for which the robot is not updated.",
+                        robot_category_, SLOT(updatePostureTolerance()), this);
+  robot_posture_tolerance_property_->setMin(0.0);
 
   // CoM position and velocity properties
   com_enable_property_ =
@@ -229,21 +337,104 @@ WholeBodyStateDisplay::WholeBodyStateDisplay()
   friction_cone_locate_at_cop_property_ = new BoolProperty(
       "Locate At Center of Pressure", false, "Collocate the friction cone with the contact's center of pressure.",
       friction_category_, SLOT(updateFrictionConeOrigin()), this);
+
+  // Trail properties
+  trail_enable_property_ =
+      new BoolProperty("Enable", false, "Enable/disable the trails of the CoM, ZMP, ICP, CMP and CoPs.",
+                       trail_category_, SLOT(updateTrailEnable()), this);
+  trail_duration_property_ = new FloatProperty("Duration", 10., "Time in seconds during which a trail is kept.",
+                                               trail_category_, SLOT(updateTrailHistory()), this);
+  trail_duration_property_->setMin(0.);
+  trail_capacity_property_ =
+      new IntProperty("Capacity", 1000,
+                      "Maximum number of segments per trail. The oldest segments are overwritten when it is reached.",
+                      trail_category_, SLOT(updateTrailHistory()), this);
+  trail_capacity_property_->setMin(1);
+
+  // Ghost properties
+  ghost_enable_property_ = new BoolProperty("Enable", false, "Enable/disable the ghosts of the latest postures.",
+                                            ghost_category_, SLOT(updateGhostEnable()), this);
+  ghost_count_property_ = new IntProperty("Count", 5, "Maximum number of ghosts per robot.", ghost_category_,
+                                          SLOT(updateGhostHistory()), this);
+  ghost_count_property_->setMin(1);
+  ghost_count_property_->setMax(50);
+  ghost_spacing_property_ = new FloatProperty("Spacing", 0.5, "Time in seconds between the postures of the ghosts.",
+                                              ghost_category_, SLOT(updateGhostHistory()), this);
+  ghost_spacing_property_->setMin(0.);
+  ghost_alpha_property_ = new FloatProperty("Alpha", 0.3, "Amount of transparency to apply to the ghosts.",
+                                            ghost_category_, SLOT(updateGhostAlpha()), this);
+  ghost_alpha_property_->setMin(0.);
+  ghost_alpha_property_->setMax(1.);
 }
 
-WholeBodyStateDisplay::~WholeBodyStateDisplay() {}
+WholeBodyStateDisplay::~WholeBodyStateDisplay() {
+  // The TF filter is destroyed by the base class, so it cannot stay connected to the input filter
+  if (tf_filter_) {
+    tf_filter_->connectInput(sub_);
+  }
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    destroyVisuals(*robots_[i]);
+  }
+  if (ghost_material_) {
+    Ogre::MaterialManager::getSingleton().remove(ghost_material_->getName());
+  }
+}
 
 void WholeBodyStateDisplay::onInitialize() {
   MFDClass::onInitialize();
-  robot_.reset(new rviz::Robot(scene_node_, context_, "Robot: " + getName().toStdString(), this));
+  // The ghosts of all the robots share a single translucent material, whose alpha is set by the ghost properties
+  static int count = 0;
+  std::stringstream ss;
+  ss << "WholeBodyStateGhostMaterial" << count++;
+  ghost_material_ =
+      Ogre::MaterialManager::getSingleton().create(ss.str(), Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+  ghost_material_->setReceiveShadows(false);
+  ghost_material_->getTechnique(0)->setSceneBlending(Ogre::SBT_TRANSPARENT_ALPHA);
+  ghost_material_->getTechnique(0)->setDepthWriteEnabled(false);
+  // The input policy runs before the TF filter, so the dropped messages are never transformed
+  input_filter_.connectInput(sub_);
+  tf_filter_->connectInput(input_filter_);
+  updateInputPolicy();
+  updateProfiling();
+  updateRenderBudget();
+  updateTrackTransform();
+  updateInterpolationDelay();
+  robots_.push_back(createRobot(""));
+  updateAdditionalTopics();
   updateRobotVisualVisible();
   updateRobotCollisionVisible();
   updateRobotAlpha();
+  updatePostureTolerance();
+
+  // Mirroring the property values into the settings, which are only updated by the slots afterwards
+  updateCoMStyle();
+  updateCoMColorAndAlpha();
+  updateCoMArrowGeometry();
+  updateZMPColorAndAlpha();
+  updateCoPColorAndAlpha();
+  updateICPColorAndAlpha();
+  updateCMPColorAndAlpha();
   updateGRFColorAndAlpha();
+  updateGRFArrowGeometry();
+  updateGRFOrigin();
+  updateSupportLineColorAndAlpha();
+  updateSupportMeshColorAndAlpha();
+  updateFrictionConeColorAndAlpha();
+  updateFrictionConeGeometry();
+  updateFrictionConeOrigin();
+  updateTrailHistory();
+  updateGhostHistory();
+  updateGhostAlpha();
 }
 
 void WholeBodyStateDisplay::onEnable() {
   MFDClass::onEnable();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    RobotInstance &robot = *robots_[i];
+    robot.processor.start();
+    createVisuals(robot);
+    subscribeRobot(robot);
+  }
   loadRobotModel();
   updateRobotEnable();
   updateCoMEnable();
@@ -254,37 +445,67 @@ void WholeBodyStateDisplay::onEnable() {
   updateGRFEnable();
   updateSupportEnable();
   updateFrictionConeEnable();
+  updateTrailEnable();
+  updateGhostEnable();
 }
 
 void WholeBodyStateDisplay::onDisable() {
   MFDClass::onDisable();
-  robot_->setVisible(false);
-  clearRobotModel();
-  // Remove all artefacts:
-  com_visual_.reset();
-  comd_visual_.reset();
-  zmp_visual_.reset();
-  cop_visual_.clear();
-  icp_visual_.reset();
-  cmp_visual_.reset();
-  grf_visual_.clear();
-  support_visual_.reset();
-  cones_visual_.clear();
+  input_filter_.clear();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    RobotInstance &robot = *robots_[i];
+    robot.subscriber.unsubscribe();
+    robot.input_filter.clear();
+    robot.processor.stop();
+    robot.has_snapshot = false;
+    robot.snapshot_buffer.clear();
+    robot.robot->setVisible(false);
+  }
+  // Remove all artefacts, while the robot model is kept so enabling the display again does not load it
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    destroyVisuals(*robots_[i]);
+  }
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::fixedFrameChanged() {
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    if (robots_[i]->tf_filter) {
+      robots_[i]->tf_filter->setTargetFrame(fixed_frame_.toStdString());
+    }
+  }
   MFDClass::fixedFrameChanged();
-  if (msg_ != nullptr) {
-    processWholeBodyState();
+  transform_cache_.clear();
+  // The snapshots do not depend on the fixed frame, so only the root nodes are posed again. The trails and ghosts
+  // were recorded in the previous fixed frame, so they restart empty.
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    clearTrails(*robots_[i]);
+    clearGhosts(*robots_[i]);
+    poseRobot(*robots_[i], settings_.track_transform);
   }
+  context_->queueRender();
 }
 
 void WholeBodyStateDisplay::reset() {
   MFDClass::reset();
-  grf_visual_.clear();
-  cones_visual_.clear();
-  cop_visual_.clear();
+  input_filter_.clear();
+  processed_messages_ = 0;
+  transform_cache_.clear();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    RobotInstance &robot = *robots_[i];
+    robot.input_filter.clear();
+    if (robot.tf_filter) {
+      robot.tf_filter->clear();
+    }
+    robot.has_snapshot = false;
+    robot.snapshot_buffer.clear();
+    robot.posture_id = std::numeric_limits<std::size_t>::max();
+    robot.grf_visual.clear();
+    robot.cones_visual.clear();
+    robot.cop_visual.clear();
+    clearTrails(robot);
+    clearGhosts(robot);
+  }
 }
 
 void WholeBodyStateDisplay::loadRobotModel() {
@@ -311,29 +532,46 @@ void WholeBodyStateDisplay::loadRobotModel() {
   if (content == robot_model_) {
     return;
   }
+  // The URDF is parsed in the background, and the models are handed off by the render loop
   robot_model_ = content;
-  urdf::Model descr;
-  if (!descr.initString(robot_model_)) {
-    clearRobotModel();
-    setStatus(StatusProperty::Error, "URDF", "Failed to parse URDF model");
+  model_loader_.load(robot_model_);
+  setStatus(StatusProperty::Warn, "URDF", "Loading");
+}
+
+void WholeBodyStateDisplay::handOffRobotModel() {
+  boost::shared_ptr<const urdf::Model> descr;
+  boost::shared_ptr<const pinocchio::Model> model;
+  std::string error_msg;
+  if (!model_loader_.getModel(descr, model, error_msg)) {
     return;
   }
-
-  // Initializing the dynamics from the URDF model
-  try {
-    pinocchio::urdf::buildModelFromXML(robot_model_, pinocchio::JointModelFreeFlyer(), model_);
-  } catch (const std::invalid_argument &e) {
-    std::string error_msg = "Failed to instantiate model: ";
-    error_msg += e.what();
-    setStatus(StatusProperty::Error, "Pinocchio-URDFParser", QString::fromStdString(error_msg));
+  if (!model) {
+    clearRobotModel();
+    setStatus(StatusProperty::Error, "URDF", QString::fromStdString(error_msg));
     ROS_ERROR_STREAM(error_msg);  // This message is potentially quite detailed.
     return;
   }
-  data_ = pinocchio::Data(model_);
-  gravity_ = model_.gravity.linear().norm();
-  weight_ = pinocchio::computeTotalMass(model_) * gravity_;
+
+  // The robots share the parsed model, while each processor owns its data. The latest message received while loading
+  // is processed with the new model.
+  model_ = model;
+  description_ = descr;
+  link_frames_.setModel(*model_);
   initialized_model_ = true;
-  robot_->load(descr);
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    RobotInstance &robot = *robots_[i];
+    robot.processor.setModel(model_);
+    robot.has_snapshot = false;
+    robot.snapshot_buffer.clear();
+    destroyGhosts(robot);
+    robot.robot->load(*description_);
+    robot.posture_id = std::numeric_limits<std::size_t>::max();
+    createGhosts(robot);
+    if (robot.pending_msg) {
+      robot.processor.submit(robot.pending_msg, getProcessingParameters());
+      robot.pending_msg.reset();
+    }
+  }
   updateRobotEnable();
   setStatus(StatusProperty::Ok, "URDF", "URDF parsed OK");
 }
@@ -341,17 +579,136 @@ void WholeBodyStateDisplay::loadRobotModel() {
 void WholeBodyStateDisplay::clearRobotModel() {
   clearStatuses();
   robot_model_.clear();
-  model_ = pinocchio::Model();
-  data_ = pinocchio::Data();
+  model_loader_.cancel();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    robots_[i]->processor.clear();
+    robots_[i]->pending_msg.reset();
+    robots_[i]->has_snapshot = false;
+    robots_[i]->snapshot_buffer.clear();
+    destroyGhosts(*robots_[i]);
+  }
+  model_.reset();
+  description_.reset();
+  link_frames_.clear();
   initialized_model_ = false;
 }
 
+boost::shared_ptr<WholeBodyStateDisplay::RobotInstance> WholeBodyStateDisplay::createRobot(const std::string &topic) {
+  boost::shared_ptr<RobotInstance> robot(new RobotInstance());
+  robot->topic = topic;
+  std::string name = "Robot: " + getName().toStdString();
+  if (!topic.empty()) {
+    name += " " + topic;
+  }
+  robot->robot.reset(new rviz::Robot(scene_node_, context_, name, this));
+  robot->robot->setVisualVisible(robot_visual_enabled_property_->getValue().toBool());
+  robot->robot->setCollisionVisible(robot_collision_enabled_property_->getValue().toBool());
+  robot->robot->setAlpha(robot_alpha_property_->getFloat());
+  robot->robot->setVisible(false);
+  robot->processor.setProfiler(&profiler_);
+
+  // The additional topics go through the same chain as the topic of the display, i.e., input policy and TF filter
+  if (!topic.empty()) {
+    robot->tf_filter.reset(new TFFilter(*context_->getTF2BufferPtr(), fixed_frame_.toStdString(),
+                                        static_cast<uint32_t>(queue_size_property_->getInt()), update_nh_));
+    robot->input_filter.connectInput(robot->subscriber);
+    robot->tf_filter->connectInput(robot->input_filter);
+    robot->tf_filter->registerCallback(
+        boost::bind(&WholeBodyStateDisplay::processRobotMessage, this, _1, robot.get()));
+    applyInputPolicy(robot->input_filter);
+  }
+  return robot;
+}
+
+void WholeBodyStateDisplay::subscribeRobot(RobotInstance &robot) {
+  if (robot.topic.empty()) {
+    return;
+  }
+  try {
+    robot.subscriber.subscribe(update_nh_, robot.topic, static_cast<uint32_t>(queue_size_property_->getInt()));
+    setStatus(StatusProperty::Ok, QString::fromStdString("Topic " + robot.topic), "OK");
+  } catch (const ros::Exception &e) {
+    setStatus(StatusProperty::Error, QString::fromStdString("Topic " + robot.topic),
+              QString("Error subscribing: ") + e.what());
+  }
+}
+
+void WholeBodyStateDisplay::createVisuals(RobotInstance &robot) {
+  if (robot.com_visual) {
+    return;
+  }
+  // The overlays hang under a root node posed at the message frame, so they are expressed in the message frame
+  Ogre::SceneManager *scene_manager = context_->getSceneManager();
+  robot.root_node = scene_node_->createChildSceneNode();
+  robot.com_visual.reset(new PointVisual(scene_manager, robot.root_node));
+  robot.comd_visual.reset(new ArrowVisual(scene_manager, robot.root_node));
+  robot.zmp_visual.reset(new PointVisual(scene_manager, robot.root_node));
+  robot.icp_visual.reset(new PointVisual(scene_manager, robot.root_node));
+  robot.cmp_visual.reset(new PointVisual(scene_manager, robot.root_node));
+  robot.support_visual.reset(new PolygonVisual(scene_manager, robot.root_node));
+  robot.net_grf_visual.reset(new ArrowVisual(scene_manager, robot.root_node));
+  robot.grf_visual.initialize(scene_manager, robot.root_node);
+  robot.cones_visual.initialize(scene_manager, robot.root_node);
+  robot.cop_visual.initialize(scene_manager, robot.root_node);
+  robot.com_trail.reset(new TrailVisual(scene_manager, scene_node_));
+  robot.zmp_trail.reset(new TrailVisual(scene_manager, scene_node_));
+  robot.icp_trail.reset(new TrailVisual(scene_manager, scene_node_));
+  robot.cmp_trail.reset(new TrailVisual(scene_manager, scene_node_));
+  robot.cop_trail.initialize(scene_manager, scene_node_);
+  robot.visual_allocations += 11;
+
+  // The visuals are hidden until the first message arrives
+  robot.com_visual->setVisible(false);
+  robot.comd_visual->setVisible(false);
+  robot.zmp_visual->setVisible(false);
+  robot.icp_visual->setVisible(false);
+  robot.cmp_visual->setVisible(false);
+  robot.support_visual->setVisible(false);
+  robot.net_grf_visual->setVisible(false);
+  applySettings(robot, Settings::ALL_GROUPS);
+  createGhosts(robot);
+}
+
+void WholeBodyStateDisplay::destroyVisuals(RobotInstance &robot) {
+  robot.com_visual.reset();
+  robot.comd_visual.reset();
+  robot.zmp_visual.reset();
+  robot.icp_visual.reset();
+  robot.cmp_visual.reset();
+  robot.support_visual.reset();
+  robot.net_grf_visual.reset();
+  robot.grf_visual.clear();
+  robot.cones_visual.clear();
+  robot.cop_visual.clear();
+  robot.com_trail.reset();
+  robot.zmp_trail.reset();
+  robot.icp_trail.reset();
+  robot.cmp_trail.reset();
+  robot.cop_trail.clear();
+  destroyGhosts(robot);
+  if (robot.root_node) {
+    context_->getSceneManager()->destroySceneNode(robot.root_node);
+    robot.root_node = nullptr;
+  }
+}
+
+std::size_t WholeBodyStateDisplay::getVisualAllocations() const {
+  std::size_t allocations = 0;
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    const RobotInstance &robot = *robots_[i];
+    allocations += robot.visual_allocations + robot.grf_visual.getAllocations() +
+                   robot.cones_visual.getAllocations() + robot.cop_visual.getAllocations() +
+                   robot.cop_trail.getAllocations();
+  }
+  return allocations;
+}
+
 void WholeBodyStateDisplay::updateRobotEnable() {
-  robot_enable_ = robot_enable_property_->getBool();
-  if (robot_enable_) {
-    robot_->setVisible(true);
-  } else {
-    robot_->setVisible(false);
+  settings_.robot_enable = robot_enable_property_->getBool();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    robots_[i]->robot->setVisible(settings_.robot_enable);
+    // The ghosts are hidden with the robot, and they capture its postures again once it is shown
+    clearGhosts(*robots_[i]);
   }
 }
 
@@ -362,28 +719,90 @@ void WholeBodyStateDisplay::updateRobotModel() {
   }
 }
 
+void WholeBodyStateDisplay::updateAdditionalTopics() {
+  if (robots_.empty()) {
+    return;
+  }
+  // The robots of the topics that are kept in the list are reused, so they keep their model and snapshot
+  std::vector<boost::shared_ptr<RobotInstance> > robots(1, robots_[0]);
+  std::istringstream topics(additional_topics_property_->getStdString());
+  std::string topic;
+  while (topics >> topic) {
+    bool listed = false;
+    for (std::size_t i = 1; i < robots.size(); ++i) {
+      listed |= robots[i]->topic == topic;
+    }
+    if (listed) {
+      continue;
+    }
+    boost::shared_ptr<RobotInstance> robot;
+    for (std::size_t i = 1; i < robots_.size(); ++i) {
+      if (robots_[i]->topic == topic) {
+        robot = robots_[i];
+      }
+    }
+    if (!robot) {
+      robot = createRobot(topic);
+      if (isEnabled()) {
+        robot->processor.start();
+        createVisuals(*robot);
+        subscribeRobot(*robot);
+        if (initialized_model_) {
+          robot->processor.setModel(model_);
+          robot->robot->load(*description_);
+          robot->robot->setVisible(settings_.robot_enable);
+          createGhosts(*robot);
+        }
+      }
+    }
+    robots.push_back(robot);
+  }
+  for (std::size_t i = 1; i < robots_.size(); ++i) {
+    if (std::find(robots.begin(), robots.end(), robots_[i]) == robots.end()) {
+      destroyVisuals(*robots_[i]);
+      deleteStatus(QString::fromStdString("Topic " + robots_[i]->topic));
+    }
+  }
+  robots_.swap(robots);
+  context_->queueRender();
+}
+
 void WholeBodyStateDisplay::updateRobotVisualVisible() {
-  robot_->setVisualVisible(robot_visual_enabled_property_->getValue().toBool());
+  settings_.robot_visual_enable = robot_visual_enabled_property_->getValue().toBool();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    robots_[i]->robot->setVisualVisible(settings_.robot_visual_enable);
+    for (std::size_t j = 0; j < robots_[i]->ghosts.size(); ++j) {
+      robots_[i]->ghosts[j]->setVisualVisible(settings_.robot_visual_enable);
+    }
+  }
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateRobotCollisionVisible() {
-  robot_->setCollisionVisible(robot_collision_enabled_property_->getValue().toBool());
+  settings_.robot_collision_enable = robot_collision_enabled_property_->getValue().toBool();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    robots_[i]->robot->setCollisionVisible(settings_.robot_collision_enable);
+    for (std::size_t j = 0; j < robots_[i]->ghosts.size(); ++j) {
+      robots_[i]->ghosts[j]->setCollisionVisible(settings_.robot_collision_enable);
+    }
+  }
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateRobotAlpha() {
-  robot_->setAlpha(robot_alpha_property_->getFloat());
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    robots_[i]->robot->setAlpha(robot_alpha_property_->getFloat());
+  }
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateCoMEnable() {
-  com_enable_ = com_enable_property_->getBool();
-  if (com_visual_ && !com_enable_) {
-    com_visual_.reset();
-  }
-  if (comd_visual_ && !com_enable_) {
-    comd_visual_.reset();
+  settings_.com_enable = com_enable_property_->getBool();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    if (robots_[i]->com_visual && !settings_.com_enable) {
+      robots_[i]->com_visual->setVisible(false);
+      robots_[i]->comd_visual->setVisible(false);
+    }
   }
   context_->queueRender();
 }
@@ -394,573 +813,875 @@ void WholeBodyStateDisplay::updateCoMStyle() {
   switch (style) {
     case REAL:
     default:
-      com_real_ = true;
+      settings_.com_real = true;
       break;
 
     case PROJECTED:
-      com_real_ = false;
+      settings_.com_real = false;
       break;
   }
 }
 
 void WholeBodyStateDisplay::updateCoMColorAndAlpha() {
-  const float &radius = com_radius_property_->getFloat();
-  Ogre::ColourValue color = com_color_property_->getOgreColor();
-  color.a = com_alpha_property_->getFloat();
-  if (com_visual_) {
-    com_visual_->setColor(color.r, color.g, color.b, color.a);
-    com_visual_->setRadius(radius);
-  }
-  if (comd_visual_) {
-    comd_visual_->setColor(color.r, color.g, color.b, color.a);
-  }
+  settings_.com.radius = com_radius_property_->getFloat();
+  settings_.com.color = com_color_property_->getOgreColor();
+  settings_.com.color.a = com_alpha_property_->getFloat();
+  settings_.dirty |= Settings::COM_APPEARANCE;
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateCoMArrowGeometry() {
-  const float &shaft_length = com_shaft_length_property_->getFloat();
-  const float &shaft_radius = com_shaft_radius_property_->getFloat();
-  const float &head_length = com_head_length_property_->getFloat();
-  const float &head_radius = com_head_radius_property_->getFloat();
-  if (comd_visual_) {
-    comd_visual_->setProperties(shaft_length, shaft_radius, head_length, head_radius);
-  }
+  settings_.com_arrow.shaft_length = com_shaft_length_property_->getFloat();
+  settings_.com_arrow.shaft_radius = com_shaft_radius_property_->getFloat();
+  settings_.com_arrow.head_length = com_head_length_property_->getFloat();
+  settings_.com_arrow.head_radius = com_head_radius_property_->getFloat();
+  settings_.dirty |= Settings::SNAPSHOT_GEOMETRY;
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateZMPEnable() {
-  zmp_enable_ = zmp_enable_property_->getBool();
-  use_contact_status_in_zmp_ = zmp_enable_status_property_->getBool();
-  if (zmp_visual_ && !zmp_enable_) {
-    zmp_visual_.reset();
+  settings_.zmp_enable = zmp_enable_property_->getBool();
+  settings_.use_contact_status_in_zmp = zmp_enable_status_property_->getBool();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    if (robots_[i]->zmp_visual && !settings_.zmp_enable) {
+      robots_[i]->zmp_visual->setVisible(false);
+    }
   }
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateZMPColorAndAlpha() {
-  const float &radius = zmp_radius_property_->getFloat();
-  Ogre::ColourValue color = zmp_color_property_->getOgreColor();
-  color.a = zmp_alpha_property_->getFloat();
-  if (zmp_visual_) {
-    zmp_visual_->setColor(color.r, color.g, color.b, color.a);
-    zmp_visual_->setRadius(radius);
-  }
+  settings_.zmp.radius = zmp_radius_property_->getFloat();
+  settings_.zmp.color = zmp_color_property_->getOgreColor();
+  settings_.zmp.color.a = zmp_alpha_property_->getFloat();
+  settings_.dirty |= Settings::ZMP_APPEARANCE;
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateCoPEnable() {
-  cop_enable_ = cop_enable_property_->getBool();
-  use_contact_status_in_cop_ = cop_enable_status_property_->getBool();
-  if (cop_visual_.size() != 0 && !cop_enable_) {
-    cop_visual_.clear();
+  settings_.cop_enable = cop_enable_property_->getBool();
+  settings_.use_contact_status_in_cop = cop_enable_status_property_->getBool();
+  if (!settings_.cop_enable) {
+    for (std::size_t i = 0; i < robots_.size(); ++i) {
+      robots_[i]->cop_visual.setVisible(false);
+    }
   }
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateCoPColorAndAlpha() {
-  const float &radius = cop_radius_property_->getFloat();
-  Ogre::ColourValue color = cop_color_property_->getOgreColor();
-  color.a = cop_alpha_property_->getFloat();
-  for (size_t i = 0; i < cop_visual_.size(); ++i) {
-    cop_visual_[i]->setColor(color.r, color.g, color.b, color.a);
-    cop_visual_[i]->setRadius(radius);
-  }
+  settings_.cop.radius = cop_radius_property_->getFloat();
+  settings_.cop.color = cop_color_property_->getOgreColor();
+  settings_.cop.color.a = cop_alpha_property_->getFloat();
+  settings_.dirty |= Settings::COP_APPEARANCE;
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateICPEnable() {
-  icp_enable_ = icp_enable_property_->getBool();
-  if (icp_visual_ && !icp_enable_) {
-    icp_visual_.reset();
+  settings_.icp_enable = icp_enable_property_->getBool();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    if (robots_[i]->icp_visual && !settings_.icp_enable) {
+      robots_[i]->icp_visual->setVisible(false);
+    }
   }
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateICPColorAndAlpha() {
-  float radius = icp_radius_property_->getFloat();
-  Ogre::ColourValue color = icp_color_property_->getOgreColor();
-  color.a = icp_alpha_property_->getFloat();
-  if (icp_visual_) {
-    icp_visual_->setColor(color.r, color.g, color.b, color.a);
-    icp_visual_->setRadius(radius);
-  }
+  settings_.icp.radius = icp_radius_property_->getFloat();
+  settings_.icp.color = icp_color_property_->getOgreColor();
+  settings_.icp.color.a = icp_alpha_property_->getFloat();
+  settings_.dirty |= Settings::ICP_APPEARANCE;
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateCMPEnable() {
-  cmp_enable_ = cmp_enable_property_->getBool();
-  if (cmp_visual_ && !cmp_enable_) {
-    cmp_visual_.reset();
+  settings_.cmp_enable = cmp_enable_property_->getBool();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    if (robots_[i]->cmp_visual && !settings_.cmp_enable) {
+      robots_[i]->cmp_visual->setVisible(false);
+    }
   }
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateCMPColorAndAlpha() {
-  const float &radius = cmp_radius_property_->getFloat();
-  Ogre::ColourValue color = cmp_color_property_->getOgreColor();
-  color.a = cmp_alpha_property_->getFloat();
-  if (cmp_visual_) {
-    cmp_visual_->setColor(color.r, color.g, color.b, color.a);
-    cmp_visual_->setRadius(radius);
-  }
+  settings_.cmp.radius = cmp_radius_property_->getFloat();
+  settings_.cmp.color = cmp_color_property_->getOgreColor();
+  settings_.cmp.color.a = cmp_alpha_property_->getFloat();
+  settings_.dirty |= Settings::CMP_APPEARANCE;
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateGRFEnable() {
-  grf_enable_ = grf_enable_property_->getBool();
-  use_contact_status_in_grf_ = grf_enable_status_property_->getBool();
-  if (grf_visual_.size() != 0 && !grf_enable_) {
-    grf_visual_.clear();
+  settings_.grf_enable = grf_enable_property_->getBool();
+  settings_.use_contact_status_in_grf = grf_enable_status_property_->getBool();
+  if (!settings_.grf_enable) {
+    for (std::size_t i = 0; i < robots_.size(); ++i) {
+      robots_[i]->grf_visual.setVisible(false);
+      if (robots_[i]->net_grf_visual) {
+        robots_[i]->net_grf_visual->setVisible(false);
+      }
+    }
   }
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateGRFColorAndAlpha() {
-  Ogre::ColourValue color = grf_color_property_->getOgreColor();
-  color.a = grf_alpha_property_->getFloat();
-  for (size_t i = 0; i < grf_visual_.size(); ++i) {
-    grf_visual_[i]->setColor(color.r, color.g, color.b, color.a);
-  }
+  settings_.grf_color = grf_color_property_->getOgreColor();
+  settings_.grf_color.a = grf_alpha_property_->getFloat();
+  settings_.dirty |= Settings::GRF_APPEARANCE;
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateGRFArrowGeometry() {
-  const float &shaft_length = grf_shaft_length_property_->getFloat();
-  const float &shaft_radius = grf_shaft_radius_property_->getFloat();
-  const float &head_length = grf_head_length_property_->getFloat();
-  const float &head_radius = grf_head_radius_property_->getFloat();
-  for (size_t i = 0; i < grf_visual_.size(); ++i) {
-    grf_visual_[i]->setProperties(shaft_length, shaft_radius, head_length, head_radius);
-  }
+  settings_.grf_arrow.shaft_length = grf_shaft_length_property_->getFloat();
+  settings_.grf_arrow.shaft_radius = grf_shaft_radius_property_->getFloat();
+  settings_.grf_arrow.head_length = grf_head_length_property_->getFloat();
+  settings_.grf_arrow.head_radius = grf_head_radius_property_->getFloat();
+  settings_.dirty |= Settings::SNAPSHOT_GEOMETRY;
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateGRFOrigin() {
-  grf_locate_at_cop_ = grf_locate_at_cop_property_->getBool();
+  settings_.grf_locate_at_cop = grf_locate_at_cop_property_->getBool();
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateSupportEnable() {
-  support_enable_ = support_enable_property_->getBool();
-  use_contact_status_in_support_ = support_enable_status_property_->getBool();
-  if (support_visual_ && !support_enable_) {
-    support_visual_.reset();
+  settings_.support_enable = support_enable_property_->getBool();
+  settings_.use_contact_status_in_support = support_enable_status_property_->getBool();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    if (robots_[i]->support_visual && !settings_.support_enable) {
+      robots_[i]->support_visual->setVisible(false);
+    }
   }
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateSupportLineColorAndAlpha() {
-  Ogre::ColourValue color = support_line_color_property_->getOgreColor();
-  color.a = support_line_alpha_property_->getFloat();
-  force_threshold_ = support_force_threshold_property_->getFloat();
-
-  float radius = support_line_radius_property_->getFloat();
-  if (support_visual_) {
-    support_visual_->setLineColor(color.r, color.g, color.b, color.a);
-    support_visual_->setLineRadius(radius);
-  }
+  settings_.support_line_color = support_line_color_property_->getOgreColor();
+  settings_.support_line_color.a = support_line_alpha_property_->getFloat();
+  settings_.support_line_radius = support_line_radius_property_->getFloat();
+  settings_.force_threshold = support_force_threshold_property_->getFloat();
+  settings_.dirty |= Settings::SUPPORT_LINE_APPEARANCE;
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateSupportMeshColorAndAlpha() {
-  Ogre::ColourValue color = support_mesh_color_property_->getOgreColor();
-  color.a = support_mesh_alpha_property_->getFloat();
-  if (support_visual_) {
-    support_visual_->setMeshColor(color.r, color.g, color.b, color.a);
-  }
+  settings_.support_mesh_color = support_mesh_color_property_->getOgreColor();
+  settings_.support_mesh_color.a = support_mesh_alpha_property_->getFloat();
+  settings_.dirty |= Settings::SUPPORT_MESH_APPEARANCE;
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateFrictionConeEnable() {
-  cone_enable_ = friction_cone_enable_property_->getBool();
-  use_contact_status_in_friction_cone_ = friction_cone_enable_status_property_->getBool();
-  if (cones_visual_.size() != 0 && !cone_enable_) {
-    cones_visual_.clear();
+  settings_.cone_enable = friction_cone_enable_property_->getBool();
+  settings_.use_contact_status_in_friction_cone = friction_cone_enable_status_property_->getBool();
+  if (!settings_.cone_enable) {
+    for (std::size_t i = 0; i < robots_.size(); ++i) {
+      robots_[i]->cones_visual.setVisible(false);
+    }
   }
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateFrictionConeColorAndAlpha() {
-  Ogre::ColourValue oc = friction_cone_color_property_->getOgreColor();
-  float alpha = friction_cone_alpha_property_->getFloat();
-  for (size_t i = 0; i < cones_visual_.size(); ++i) {
-    cones_visual_[i]->setColor(oc.r, oc.g, oc.b, alpha);
-  }
+  settings_.cone_color = friction_cone_color_property_->getOgreColor();
+  settings_.cone_color.a = friction_cone_alpha_property_->getFloat();
+  settings_.dirty |= Settings::CONE_APPEARANCE;
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateFrictionConeGeometry() {
-  const float &cone_length = friction_cone_length_property_->getFloat();
-  const float cone_width = 2.0 * cone_length * tan(friction_mu_ / sqrt(2.));
-  for (size_t i = 0; i < cones_visual_.size(); ++i) {
-    cones_visual_[i]->setProperties(cone_width, cone_length);
-  }
+  settings_.cone_length = friction_cone_length_property_->getFloat();
+  settings_.dirty |= Settings::SNAPSHOT_GEOMETRY;
   context_->queueRender();
 }
 
 void WholeBodyStateDisplay::updateFrictionConeOrigin() {
-  friction_cone_locate_at_cop_ = friction_cone_locate_at_cop_property_->getBool();
+  settings_.friction_cone_locate_at_cop = friction_cone_locate_at_cop_property_->getBool();
+  context_->queueRender();
+}
+
+void WholeBodyStateDisplay::updateInputPolicy() {
+  InputFilter::Policy policy = (InputFilter::Policy)input_policy_property_->getOptionInt();
+  switch (policy) {
+    case InputFilter::ALL:
+    case InputFilter::LATEST_ONLY:
+      input_max_rate_property_->hide();
+      input_keep_every_property_->hide();
+      break;
+    case InputFilter::MAX_RATE:
+      input_max_rate_property_->show();
+      input_keep_every_property_->hide();
+      break;
+    case InputFilter::KEEP_EVERY_NTH:
+      input_max_rate_property_->hide();
+      input_keep_every_property_->show();
+      break;
+  }
+  applyInputPolicy(input_filter_);
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    applyInputPolicy(robots_[i]->input_filter);
+  }
+}
+
+void WholeBodyStateDisplay::applyInputPolicy(InputFilter &filter) {
+  filter.setPolicy((InputFilter::Policy)input_policy_property_->getOptionInt(), input_max_rate_property_->getFloat(),
+                   input_keep_every_property_->getInt());
+}
+
+void WholeBodyStateDisplay::updateProfiling() {
+  const bool enable = profiling_enable_property_->getBool();
+  profiler_.setEnabled(enable);
+  if (!enable) {
+    deleteStatus("Performance");
+  }
+  profiler_.closeCsv();
+  deleteStatus("Performance CSV");
+  const std::string csv_file = profiling_csv_property_->getStdString();
+  if (enable && !csv_file.empty() && !profiler_.openCsv(csv_file)) {
+    setStatus(StatusProperty::Error, "Performance CSV",
+              "Failed to open [" + profiling_csv_property_->getString() + "]");
+  }
+}
+
+void WholeBodyStateDisplay::updateTrackTransform() {
+  settings_.track_transform = track_transform_property_->getBool();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    poseRobot(*robots_[i], settings_.track_transform);
+  }
+  context_->queueRender();
+}
+
+void WholeBodyStateDisplay::updateInterpolationDelay() {
+  settings_.interpolation_delay = interpolation_delay_property_->getFloat();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    robots_[i]->snapshot_buffer.clear();
+  }
+}
+
+void WholeBodyStateDisplay::updateTrailEnable() {
+  settings_.trail_enable = trail_enable_property_->getBool();
+  if (!settings_.trail_enable) {
+    for (std::size_t i = 0; i < robots_.size(); ++i) {
+      clearTrails(*robots_[i]);
+    }
+  }
+  settings_.dirty |= Settings::TRAIL_HISTORY;
   context_->queueRender();
 }
 
+void WholeBodyStateDisplay::updateTrailHistory() {
+  settings_.trail_duration = trail_duration_property_->getFloat();
+  settings_.trail_capacity = trail_capacity_property_->getInt();
+  settings_.dirty |= Settings::TRAIL_HISTORY;
+  context_->queueRender();
+}
+
+void WholeBodyStateDisplay::updateGhostEnable() {
+  settings_.ghost_enable = ghost_enable_property_->getBool();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    if (settings_.ghost_enable) {
+      createGhosts(*robots_[i]);
+    } else {
+      destroyGhosts(*robots_[i]);
+    }
+  }
+  context_->queueRender();
+}
+
+void WholeBodyStateDisplay::updateGhostHistory() {
+  // The captured postures no longer match the spacing, so the ghosts are captured again. They are only created again
+  // when their count changed.
+  const std::size_t ghost_count = ghost_count_property_->getInt();
+  settings_.ghost_spacing = ghost_spacing_property_->getFloat();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    if (ghost_count != settings_.ghost_count) {
+      destroyGhosts(*robots_[i]);
+    } else {
+      clearGhosts(*robots_[i]);
+    }
+  }
+  settings_.ghost_count = ghost_count;
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    createGhosts(*robots_[i]);
+  }
+  context_->queueRender();
+}
+
+void WholeBodyStateDisplay::updateGhostAlpha() {
+  // The ghosts share the material, so they are all updated at once
+  settings_.ghost_alpha = ghost_alpha_property_->getFloat();
+  ghost_material_->getTechnique(0)->setAmbient(0.5, 0.5, 0.5);
+  ghost_material_->getTechnique(0)->setDiffuse(0.8, 0.8, 0.8, settings_.ghost_alpha);
+  context_->queueRender();
+}
+
+void WholeBodyStateDisplay::updateRenderBudget() {
+  render_budget_.setBudget(render_budget_property_->getFloat() * 1e-3);
+  if (render_budget_.getBudget() == 0.) {
+    deleteStatus("Render Budget");
+  }
+  applyRenderLevel();
+}
+
 void WholeBodyStateDisplay::processMessage(const whole_body_state_msgs::WholeBodyState::ConstPtr &msg) {
-  msg_ = msg;
-  has_new_msg_ = true;
+  submitMessage(*robots_[0], msg);
+}
+
+void WholeBodyStateDisplay::processRobotMessage(const whole_body_state_msgs::WholeBodyState::ConstPtr &msg,
+                                                RobotInstance *robot) {
+  submitMessage(*robot, msg);
+}
+
+void WholeBodyStateDisplay::updatePostureTolerance() {
+  settings_.posture_tolerance = robot_posture_tolerance_property_->getFloat();
+}
+
+void WholeBodyStateDisplay::submitMessage(RobotInstance &robot,
+                                          const whole_body_state_msgs::WholeBodyState::ConstPtr &msg) {
+  // The message is decoded in the background thread, which only keeps the latest one. The latest message is also
+  // kept while the robot model is loading.
+  if (!initialized_model_) {
+    robot.pending_msg = msg;
+    return;
+  }
+  robot.processor.submit(msg, getProcessingParameters());
+}
+
+ProcessingParameters WholeBodyStateDisplay::getProcessingParameters() const {
+  ProcessingParameters params;
+  // The kinematics are not needed when no representation of the robot is drawn
+  params.robot_enable = settings_.robot_enable && (settings_.robot_visual_enable || settings_.robot_collision_enable);
+  params.posture_tolerance = settings_.posture_tolerance;
+  params.cop_enable = settings_.cop_enable;
+  params.force_threshold = settings_.force_threshold;
+  params.torque_threshold = settings_.torque_threshold;
+  params.use_contact_status_in_zmp = settings_.use_contact_status_in_zmp;
+  params.use_contact_status_in_cop = settings_.use_contact_status_in_cop;
+  params.use_contact_status_in_grf = settings_.use_contact_status_in_grf;
+  params.use_contact_status_in_support = settings_.use_contact_status_in_support;
+  params.use_contact_status_in_friction_cone = settings_.use_contact_status_in_friction_cone;
+  params.grf_locate_at_cop = settings_.grf_locate_at_cop;
+  params.friction_cone_locate_at_cop = settings_.friction_cone_locate_at_cop;
+  params.com_real = settings_.com_real;
+  return params;
 }
 
-void WholeBodyStateDisplay::processWholeBodyState() {
+bool WholeBodyStateDisplay::receiveSnapshot(RobotInstance &robot, const ros::Time &time) {
+  // The snapshots are buffered as they arrive, while messages without stamp cannot be interpolated
+  if (robot.processor.getSnapshot(robot.received_snapshot)) {
+    ++processed_messages_;
+    if (robot.received_snapshot.stamp.isZero()) {
+      robot.snapshot_buffer.clear();
+      std::swap(robot.snapshot, robot.received_snapshot);
+      robot.has_snapshot = true;
+      return true;
+    }
+    robot.snapshot_buffer.push(robot.received_snapshot);
+  }
+  if (!robot.snapshot_buffer.sample(time, robot.snapshot)) {
+    return false;
+  }
+  robot.has_snapshot = true;
+  return true;
+}
+
+bool WholeBodyStateDisplay::poseRobot(RobotInstance &robot, bool latest) {
   // Checking if the urdf model was initialized
-  if (!initialized_model_) return;
+  if (!initialized_model_ || !robot.has_snapshot || !robot.root_node) return false;
+  const WholeBodyStateSnapshot &snapshot = robot.snapshot;
 
   // Here we call the rviz::FrameManager to get the transform from the
   // fixed frame to the frame in the header of this Point message.  If
   // it fails, we can't do anything else so we return.
   Ogre::Quaternion orientation;
   Ogre::Vector3 position;
-  if (!context_->getFrameManager()->getTransform(msg_->header.frame_id, msg_->header.stamp, position, orientation)) {
-    ROS_DEBUG("Error transforming from frame '%s' to frame '%s'", msg_->header.frame_id.c_str(),
+  StageProfiler::ScopedTimer transform_timer(&profiler_, StageProfiler::TRANSFORM_LOOKUP);
+  const ros::Time stamp = latest ? ros::Time() : snapshot.stamp;
+  const bool has_transform =
+      transform_cache_.getTransform(context_->getFrameManager(), snapshot.frame_id, stamp, position, orientation);
+  transform_timer.stop();
+  if (!has_transform) {
+    ROS_DEBUG("Error transforming from frame '%s' to frame '%s'", snapshot.frame_id.c_str(),
               qPrintable(fixed_frame_));
+    return false;
+  }
+
+  // The overlays are expressed in the message frame, so only their root node and the robot are posed
+  robot.root_node->setPosition(position);
+  robot.root_node->setOrientation(orientation);
+  robot.robot->setPosition(position);
+  robot.robot->setOrientation(orientation);
+  return true;
+}
+
+void WholeBodyStateDisplay::applySnapshot(RobotInstance &robot, bool received) {
+  // The snapshot follows the latest transform as the frames in between, so the pose does not jump back to the
+  // message stamp. Interpolated snapshots are posed at their stamp, which is already in the past.
+  if (!poseRobot(robot, settings_.track_transform && settings_.interpolation_delay == 0.)) {
     return;
   }
+  const WholeBodyStateSnapshot &snapshot = robot.snapshot;
 
   // Display the robot
-  if (robot_enable_) {
-    Eigen::VectorXd q = Eigen::VectorXd::Zero(model_.nq);
-    q(3) = msg_->centroidal.base_orientation.x;
-    q(4) = msg_->centroidal.base_orientation.y;
-    q(5) = msg_->centroidal.base_orientation.z;
-    q(6) = msg_->centroidal.base_orientation.w;
-    std::size_t n_joints = msg_->joints.size();
-    for (std::size_t j = 0; j < n_joints; ++j) {
-      pinocchio::JointIndex jointId = model_.getJointId(msg_->joints[j].name) - 2;
-      q(jointId + 7) = msg_->joints[j].position;
-    }
-    pinocchio::centerOfMass(model_, data_, q);
-    q(0) = msg_->centroidal.com_position.x - data_.com[0](0);
-    q(1) = msg_->centroidal.com_position.y - data_.com[0](1);
-    q(2) = msg_->centroidal.com_position.z - data_.com[0](2);
-    robot_->setPosition(position);
-    robot_->setOrientation(orientation);
-    robot_->update(PinocchioLinkUpdater(model_, data_, q, boost::bind(linkUpdaterStatusFunction, _1, _2, _3, this)));
-  }
-
-  // Resetting the point visualizers
-  if (com_enable_) {
-    com_visual_.reset(new PointVisual(context_->getSceneManager(), scene_node_));
-    comd_visual_.reset(new ArrowVisual(context_->getSceneManager(), scene_node_));
-  }
-  if (support_enable_) {
-    support_visual_.reset(new PolygonVisual(context_->getSceneManager(), scene_node_));
-  }
-
-  // Now set or update the contents of the chosen GRF visual
-  std::vector<Ogre::Vector3> support;
-  size_t num_contacts = msg_->contacts.size();
-  size_t n_suppcontacts = 0;
-  grf_visual_.clear();
-  cones_visual_.clear();
-  cop_visual_.clear();
-  Eigen::Vector3d zmp_pos = Eigen::Vector3d::Zero();
-  Eigen::Vector3d total_force = Eigen::Vector3d::Zero();
-  for (size_t i = 0; i < num_contacts; ++i) {
-    const whole_body_state_msgs::ContactState &contact = msg_->contacts[i];
-    std::string name = contact.name;
-
-    // Getting the contact position and orientation
-    Ogre::Vector3 contact_pos(contact.pose.position.x, contact.pose.position.y, contact.pose.position.z);
-    Eigen::Vector3d contact_ref_dir = Eigen::Vector3d::UnitZ();
-    Eigen::Vector3d contact_dir(contact.surface_normal.x, contact.surface_normal.y, contact.surface_normal.z);
-    Eigen::Quaterniond contact_q;
-    contact_q.setFromTwoVectors(contact_ref_dir, contact_dir);
-    Ogre::Quaternion contact_orientation(contact_q.w(), contact_q.x(), contact_q.y(), contact_q.z());
-
-    // Getting the force direction
-    Eigen::Vector3d for_ref_dir = -Eigen::Vector3d::UnitZ();
-    Eigen::Vector3d for_dir(contact.wrench.force.x, contact.wrench.force.y, contact.wrench.force.z);
-
-    // Getting the contact's center of pressure
-    // NOTE: x component is negative due to right-hand rotation rule
-    Eigen::Vector3d cop_pos = Eigen::Vector3d(-contact.wrench.torque.y / contact.wrench.force.z,
-                                              contact.wrench.torque.x / contact.wrench.force.z,
-                                              0.0);  // Origin of frame is already at contact position
-    Ogre::Vector3 cop_point(cop_pos(0), cop_pos(1), cop_pos(2));
-
-    // Updating the ZMP
-    bool active_contact_in_zmp = false;
-    if (use_contact_status_in_zmp_) {
-      active_contact_in_zmp = contact.status == contact.ACTIVE;
-    } else {
-      active_contact_in_zmp = for_dir.norm() > force_threshold_;
-    }
-    if (contact.type == contact.LOCOMOTION && active_contact_in_zmp) {
-      zmp_pos += contact.wrench.force.z *
-                 Eigen::Vector3d(contact.pose.position.x, contact.pose.position.y, contact.pose.position.z);
-      Eigen::Vector3d force_lin =
-          Eigen::Vector3d(contact.wrench.force.x, contact.wrench.force.y, contact.wrench.force.z);
-      total_force += force_lin;
-      if (force_lin.norm() != 0) {
-        n_suppcontacts += 1;
-      }
+  StageProfiler::ScopedTimer visual_timer(&profiler_, StageProfiler::VISUAL_UPDATE);
+  if (settings_.robot_enable && snapshot.has_robot) {
+    // The links are only updated when the processor computed new placements, or when they are blended
+    if (snapshot.posture_id == 0 || snapshot.posture_id != robot.posture_id) {
+      robot.robot->update(PinocchioLinkUpdater(link_frames_, snapshot.frame_placements,
+                                               boost::bind(linkUpdaterStatusFunction, _1, _2, _3, this)));
+      robot.posture_id = snapshot.posture_id;
     }
+    if (settings_.ghost_enable) {
+      captureGhost(robot);
+    }
+  }
 
-    // Center of pressure per contact. Mainly targets surface contacts (relatively meaningless for point contacts)
-    bool active_contact_in_cop = false;
-    if (use_contact_status_in_cop_) {
-      active_contact_in_cop = contact.status == contact.ACTIVE;
-    } else {
-      active_contact_in_cop = for_dir.norm() > force_threshold_;
+  // The contact overlays and the support region are only updated every other new snapshot at the decimated level of
+  // detail, and they keep their previous pose meanwhile. A snapshot applied again always updates them, since the
+  // settings that they depend on changed.
+  const bool decimated =
+      received && render_budget_.getLevel() >= RenderBudget::DECIMATED && robot.applied_snapshots++ % 2 != 0;
+  if (!decimated) {
+    applyContactSnapshot(robot);
+  }
+
+  // Now set or update the contents of the chosen CoM visual
+  const bool com_visible = settings_.com_enable && snapshot.com_visible;
+  robot.com_visual->setVisible(com_visible);
+  robot.comd_visual->setVisible(com_visible);
+  if (com_visible) {
+    Ogre::Vector3 com_point(snapshot.com(0), snapshot.com(1), snapshot.com(2));
+    Ogre::Quaternion comd_for_orientation(
+        snapshot.com_velocity_orientation.w(), snapshot.com_velocity_orientation.x(),
+        snapshot.com_velocity_orientation.y(), snapshot.com_velocity_orientation.z());
+    robot.com_visual->setPoint(com_point);
+    const double &com_vel_norm = snapshot.com_velocity.norm();
+    const float shaft_length = settings_.com_arrow.shaft_length * com_vel_norm;
+    const float &shaft_radius = settings_.com_arrow.shaft_radius;
+    float head_length = 0., head_radius = 0.;
+    if (com_vel_norm > 0.01) {
+      head_length = settings_.com_arrow.head_length;
+      head_radius = settings_.com_arrow.head_radius;
     }
-    bool is_contact_6d = false;
-    if (std::abs(contact.wrench.torque.x) > torque_threshold_ ||
-        std::abs(contact.wrench.torque.y) > torque_threshold_) {
-      is_contact_6d = true;
+    robot.comd_visual->setProperties(shaft_length, shaft_radius, head_length, head_radius);
+    robot.comd_visual->setArrow(com_point, comd_for_orientation);
+  }
+
+  // Now set or update the contents of the ZMP, ICP and CMP visuals
+  const Ogre::Vector3 zmp_point(snapshot.zmp(0), snapshot.zmp(1), snapshot.zmp(2));
+  const bool zmp_visible = snapshot.has_support && settings_.zmp_enable && snapshot.zmp.allFinite();
+  robot.zmp_visual->setVisible(zmp_visible);
+  if (zmp_visible) {
+    robot.zmp_visual->setPoint(zmp_point);
+  }
+
+  const Ogre::Vector3 icp_point(snapshot.icp(0), snapshot.icp(1), snapshot.icp(2));
+  const bool icp_visible = snapshot.has_support && settings_.icp_enable && snapshot.icp.allFinite();
+  robot.icp_visual->setVisible(icp_visible);
+  if (icp_visible) {
+    robot.icp_visual->setPoint(icp_point);
+  }
+
+  const Ogre::Vector3 cmp_point(snapshot.cmp(0), snapshot.cmp(1), snapshot.cmp(2));
+  const bool cmp_visible = snapshot.has_support && settings_.cmp_enable && snapshot.cmp.allFinite();
+  robot.cmp_visual->setVisible(cmp_visible);
+  if (cmp_visible) {
+    robot.cmp_visual->setPoint(cmp_point);
+  }
+
+  // Extending the trails, which only upload their new segment
+  if (settings_.trail_enable) {
+    const double time = getSnapshotTime(snapshot);
+    const Ogre::Vector3 com_point(snapshot.com(0), snapshot.com(1), snapshot.com(2));
+    extendTrail(*robot.com_trail, com_visible, com_point, *robot.root_node, time);
+    extendTrail(*robot.zmp_trail, zmp_visible, zmp_point, *robot.root_node, time);
+    extendTrail(*robot.icp_trail, icp_visible, icp_point, *robot.root_node, time);
+    extendTrail(*robot.cmp_trail, cmp_visible, cmp_point, *robot.root_node, time);
+  }
+
+  visual_timer.stop();
+
+  // Now set or update the contents of the support polygon visual
+  StageProfiler::ScopedTimer polygon_timer(&profiler_, StageProfiler::POLYGON_BUILD);
+  robot.support_visual->setVisible(settings_.support_enable);
+  if (settings_.support_enable && !decimated) {
+    std::vector<Ogre::Vector3> support;
+    support.reserve(snapshot.support.size());
+    for (std::size_t i = 0; i < snapshot.support.size(); ++i) {
+      const Eigen::Vector3d &vertex = snapshot.support[i];
+      support.push_back(Ogre::Vector3(vertex(0), vertex(1), vertex(2)));
     }
-    if (cop_enable_ && active_contact_in_cop && is_contact_6d) {
-      if (std::isfinite(cop_pos(0)) && std::isfinite(cop_pos(1)) && std::isfinite(cop_pos(2))) {
-        boost::shared_ptr<PointVisual> cop;
-        cop.reset(new PointVisual(context_->getSceneManager(), scene_node_));
+    robot.support_visual->setVertices(support);
+  }
+  polygon_timer.stop();
+}
+
+void WholeBodyStateDisplay::applyContactSnapshot(RobotInstance &robot) {
+  const WholeBodyStateSnapshot &snapshot = robot.snapshot;
+  const bool grf_enable = settings_.grf_enable && render_budget_.getLevel() < RenderBudget::MERGED_FORCES;
+
+  // Growing or shrinking the contact visuals only when the number of contacts changes. Otherwise, they are updated
+  // in place
+  size_t num_contacts = snapshot.contacts.size();
+  if (grf_enable && robot.grf_visual.resize(num_contacts)) {
+    applySettings(robot, Settings::GRF_APPEARANCE);
+  }
+  if (settings_.cone_enable && robot.cones_visual.resize(num_contacts)) {
+    applySettings(robot, Settings::CONE_APPEARANCE);
+  }
+  if (settings_.cop_enable && robot.cop_visual.resize(num_contacts)) {
+    applySettings(robot, Settings::COP_APPEARANCE);
+  }
+  if (settings_.trail_enable && robot.cop_trail.resize(num_contacts)) {
+    applySettings(robot, Settings::COP_APPEARANCE | Settings::TRAIL_HISTORY);
+  }
+  const double time = getSnapshotTime(snapshot);
+  for (size_t i = 0; i < num_contacts; ++i) {
+    const ContactSnapshot &contact = snapshot.contacts[i];
+    Ogre::Vector3 contact_pos(contact.position(0), contact.position(1), contact.position(2));
+    Ogre::Quaternion contact_orientation(contact.orientation.w(), contact.orientation.x(), contact.orientation.y(),
+                                         contact.orientation.z());
+    Ogre::Vector3 cop_point(contact.cop(0), contact.cop(1), contact.cop(2));
+
+    // Center of pressure per contact
+    if (settings_.cop_enable) {
+      const boost::shared_ptr<PointVisual> &cop = robot.cop_visual[i];
+      if (contact.cop_visible) {
         cop->setPoint(cop_point);
         cop->setFramePosition(contact_pos);
         cop->setFrameOrientation(contact_orientation);
-
-        // Setting color and properties
-        const float &radius = cop_radius_property_->getFloat();
-        Ogre::ColourValue color = cop_color_property_->getOgreColor();
-        color.a = cop_alpha_property_->getFloat();
-        cop->setColor(color.r, color.g, color.b, color.a);
-        cop->setRadius(radius);
-
-        cop_visual_.push_back(cop);
       }
+      cop->setVisible(contact.cop_visible);
+    }
+    if (settings_.trail_enable) {
+      extendTrail(*robot.cop_trail[i], settings_.cop_enable && contact.cop_visible,
+                  contact_pos + contact_orientation * cop_point, *robot.root_node, time);
     }
 
-    // Building the support polygon
-    if (std::isfinite(contact_pos.x) && std::isfinite(contact_pos.y) && std::isfinite(contact_pos.z)) {
-      Eigen::Quaterniond for_q;
-      for_q.setFromTwoVectors(for_ref_dir, for_dir);
-      Ogre::Quaternion contact_for_orientation(for_q.w(), for_q.x(), for_q.y(), for_q.z());
-
-      // We are keeping a vector of visual pointers. This creates the next
-      // one and stores it in the vector
-      bool active_contact_in_grf = false;
-      if (use_contact_status_in_grf_) {
-        active_contact_in_grf = contact.status == contact.ACTIVE;
+    // Contact forces, which we are keeping in a pool of visual pointers
+    bool grf_visible = false;
+    if (grf_enable && contact.grf_visible) {
+      Ogre::Quaternion contact_for_orientation(contact.force_orientation.w(), contact.force_orientation.x(),
+                                               contact.force_orientation.y(), contact.force_orientation.z());
+      const boost::shared_ptr<ArrowVisual> &arrow = robot.grf_visual[i];
+      if (contact.grf_at_cop && settings_.cop_enable) {
+        // The arrow is located in the contact frame, so its orientation is expressed w.r.t. the contact surface
+        arrow->setArrow(cop_point, contact_orientation.Inverse() * contact_for_orientation);
+        arrow->setFramePosition(contact_pos);
+        arrow->setFrameOrientation(contact_orientation);
       } else {
-        active_contact_in_grf = for_dir.norm() > force_threshold_;
+        arrow->setArrow(contact_pos, contact_for_orientation);
+        arrow->setFramePosition(Ogre::Vector3::ZERO);
+        arrow->setFrameOrientation(Ogre::Quaternion::IDENTITY);
       }
-      if (grf_enable_ && active_contact_in_grf) {
-        boost::shared_ptr<ArrowVisual> arrow;
-        arrow.reset(new ArrowVisual(context_->getSceneManager(), scene_node_));
-        if (grf_locate_at_cop_ && cop_enable_ && active_contact_in_cop && is_contact_6d) {
-          // Find the rotation between orientation (robot) and contact_orientation (surface), which we need to add on
-          // to contact_for_orientation to ensure the arrow is pointing in the right direction
-          Ogre::Quaternion surface_rotation_adjustment = orientation * contact_orientation.Inverse();
-          arrow->setArrow(cop_point, surface_rotation_adjustment * contact_for_orientation);
-          arrow->setFramePosition(contact_pos);
-          arrow->setFrameOrientation(contact_orientation);
-        } else {
-          arrow->setArrow(contact_pos, contact_for_orientation);
-          arrow->setFramePosition(position);
-          arrow->setFrameOrientation(orientation);
-        }
 
-        // Setting the arrow color and properties
-        Ogre::ColourValue color = grf_color_property_->getOgreColor();
-        color.a = grf_alpha_property_->getFloat();
-        arrow->setColor(color.r, color.g, color.b, color.a);
-        const float &shaft_length = grf_shaft_length_property_->getFloat() * for_dir.norm() / weight_;
-        const float &shaft_radius = grf_shaft_radius_property_->getFloat();
-        const float &head_length = grf_head_length_property_->getFloat();
-        const float &head_radius = grf_head_radius_property_->getFloat();
-        arrow->setProperties(shaft_length, shaft_radius, head_length, head_radius);
-
-        // And send it to the end of the vector
-        if (std::isfinite(shaft_length) && std::isfinite(shaft_radius) && std::isfinite(head_length) &&
-            std::isfinite(head_radius)) {
-          grf_visual_.push_back(arrow);
-        }
-      }
+      // Setting the arrow properties
+      const float shaft_length = settings_.grf_arrow.shaft_length * contact.force_ratio;
+      const float &shaft_radius = settings_.grf_arrow.shaft_radius;
+      const float &head_length = settings_.grf_arrow.head_length;
+      const float &head_radius = settings_.grf_arrow.head_radius;
+      arrow->setProperties(shaft_length, shaft_radius, head_length, head_radius);
 
-      bool active_contact_in_support = false;
-      if (use_contact_status_in_support_) {
-        active_contact_in_support = contact.status == contact.ACTIVE;
-      } else {
-        active_contact_in_support = for_dir.norm() > force_threshold_;
-      }
-      if (support_enable_ && active_contact_in_support && contact.type == contact.LOCOMOTION) {
-        support.push_back(contact_pos);
-      }
+      // And show it only if it is well defined
+      grf_visible = std::isfinite(shaft_length) && std::isfinite(shaft_radius) && std::isfinite(head_length) &&
+                    std::isfinite(head_radius);
+    }
+    if (grf_enable) {
+      robot.grf_visual[i]->setVisible(grf_visible);
     }
 
-    // Building the friction cones
-    bool active_contact_in_cone = false;
-    if (use_contact_status_in_friction_cone_) {
-      active_contact_in_cone = contact.status == contact.ACTIVE;
-    } else {
-      active_contact_in_cone = for_dir.norm() > force_threshold_;
-    }
-    Eigen::Vector3d cone_dir(contact.surface_normal.x, contact.surface_normal.y, contact.surface_normal.z);
-    friction_mu_ = contact.friction_coefficient;
-    if (cone_enable_ && active_contact_in_cone && cone_dir.norm() != 0 && friction_mu_ != 0) {
-      Eigen::Vector3d cone_ref_dir = -Eigen::Vector3d::UnitY();
-      Eigen::Quaterniond cone_q;
-      cone_q.setFromTwoVectors(cone_ref_dir, cone_dir);
-      Ogre::Quaternion cone_orientation(cone_q.w(), cone_q.x(), cone_q.y(), cone_q.z());
-      boost::shared_ptr<ConeVisual> cone;
-      cone.reset(new ConeVisual(context_->getSceneManager(), scene_node_));
-      if (friction_cone_locate_at_cop_ && cop_enable_ && active_contact_in_cop && is_contact_6d) {
-        // Find the rotation between orientation (robot) and contact_orientation (surface), which we need to add on
-        // to contact_for_orientation to ensure the arrow is pointing in the right direction
-        Ogre::Quaternion surface_rotation_adjustment = orientation * contact_orientation.Inverse();
-        cone->setCone(cop_point, surface_rotation_adjustment * cone_orientation);
+    // Friction cones
+    bool cone_visible = false;
+    if (settings_.cone_enable && contact.cone_visible) {
+      Ogre::Quaternion cone_orientation(contact.cone_orientation.w(), contact.cone_orientation.x(),
+                                        contact.cone_orientation.y(), contact.cone_orientation.z());
+      const boost::shared_ptr<ConeVisual> &cone = robot.cones_visual[i];
+      if (contact.cone_at_cop && settings_.cop_enable) {
+        // The cone is located in the contact frame, so its orientation is expressed w.r.t. the contact surface
+        cone->setCone(cop_point, contact_orientation.Inverse() * cone_orientation);
         cone->setFramePosition(contact_pos);
         cone->setFrameOrientation(contact_orientation);
       } else {
         cone->setCone(contact_pos, cone_orientation);
-        cone->setFramePosition(position);
-        cone->setFrameOrientation(orientation);
+        cone->setFramePosition(Ogre::Vector3::ZERO);
+        cone->setFrameOrientation(Ogre::Quaternion::IDENTITY);
       }
 
-      // Setting the cone color and properties
-      Ogre::ColourValue color = friction_cone_color_property_->getOgreColor();
-      color.a = friction_cone_alpha_property_->getFloat();
-      cone->setColor(color.r, color.g, color.b, color.a);
-      const float &cone_length = friction_cone_length_property_->getFloat();
-      const float cone_width = 2.0 * cone_length * tan(friction_mu_ / sqrt(2.));
+      // Setting the cone properties
+      const float &cone_length = settings_.cone_length;
+      const float cone_width = 2.0 * cone_length * tan(contact.friction_mu / sqrt(2.));
       cone->setProperties(cone_width, cone_length);
 
-      // And send it to the end of the vector
-      if (std::isfinite(cone_width) && std::isfinite(cone_length)) {
-        cones_visual_.push_back(cone);
-      }
+      // And show it only if it is well defined
+      cone_visible = std::isfinite(cone_width) && std::isfinite(cone_length);
+    }
+    if (settings_.cone_enable) {
+      robot.cones_visual[i]->setVisible(cone_visible);
     }
   }
 
-  // Building the ZMP visual
-  if (n_suppcontacts != 0) {
-    zmp_pos /= total_force(2);
+  // Net contact force, which replaces the contact forces at the merged level of detail
+  const bool net_grf_visible = settings_.grf_enable && !grf_enable && snapshot.net_force_visible;
+  robot.net_grf_visual->setVisible(net_grf_visible);
+  if (net_grf_visible) {
+    const Ogre::Vector3 net_force_pos(snapshot.net_force_position(0), snapshot.net_force_position(1),
+                                      snapshot.net_force_position(2));
+    const Eigen::Quaterniond &net_force_quat = snapshot.net_force_orientation;
+    const Ogre::Quaternion net_force_orientation(net_force_quat.w(), net_force_quat.x(), net_force_quat.y(),
+                                                 net_force_quat.z());
+    robot.net_grf_visual->setArrow(net_force_pos, net_force_orientation);
+    robot.net_grf_visual->setProperties(settings_.grf_arrow.shaft_length * snapshot.net_force_ratio,
+                                        settings_.grf_arrow.shaft_radius, settings_.grf_arrow.head_length,
+                                        settings_.grf_arrow.head_radius);
   }
+}
 
-  // Defining the center of mass as Ogre::Vector3
-  Ogre::Vector3 com_point;
-  if (!com_real_ && n_suppcontacts != 0) {
-    Eigen::Vector3d cop_z = Eigen::Vector3d::Zero();
-    cop_z(2) = zmp_pos(2);
-    pinocchio::SE3::Quaternion q(msg_->centroidal.base_orientation.w, msg_->centroidal.base_orientation.x,
-                                 msg_->centroidal.base_orientation.y, msg_->centroidal.base_orientation.z);
-    Eigen::Vector3d rot_cop_z = q.matrix() * cop_z;
-    com_point.x = msg_->centroidal.com_position.x + rot_cop_z(0);
-    com_point.y = msg_->centroidal.com_position.y + rot_cop_z(1);
-    com_point.z = cop_z(2);
-  } else {
-    com_point.x = msg_->centroidal.com_position.x;
-    com_point.y = msg_->centroidal.com_position.y;
-    com_point.z = msg_->centroidal.com_position.z;
+void WholeBodyStateDisplay::captureGhost(RobotInstance &robot) {
+  const WholeBodyStateSnapshot &snapshot = robot.snapshot;
+  const double time = getSnapshotTime(snapshot);
+  const double elapsed = time - robot.ghost_time;
+  if (robot.ghosts.empty() || elapsed == 0. || (elapsed > 0. && elapsed < settings_.ghost_spacing)) {
+    return;
   }
+  robot.ghost_time = time;
+
+  // The oldest ghost is overwritten. It is kept in the fixed frame, so it takes the pose that the snapshot was
+  // applied with, while the placements are expressed in the message frame as for the robot.
+  GhostVisual &ghost = *robot.ghosts[robot.next_ghost];
+  ghost.setFramePosition(robot.root_node->getPosition());
+  ghost.setFrameOrientation(robot.root_node->getOrientation());
+  ghost.setPosture(snapshot.frame_placements);
+  ghost.setVisible(true);
+  robot.next_ghost = (robot.next_ghost + 1) % robot.ghosts.size();
+}
 
-  // Defining the center of mass velocity orientation
-  Eigen::Vector3d com_ref_dir = -Eigen::Vector3d::UnitZ();
-  Eigen::Vector3d com_vel(msg_->centroidal.com_velocity.x, msg_->centroidal.com_velocity.y,
-                          msg_->centroidal.com_velocity.z);
-  Eigen::Quaterniond com_q;
-  com_q.setFromTwoVectors(com_ref_dir, com_vel);
-  Ogre::Quaternion comd_for_orientation(com_q.w(), com_q.x(), com_q.y(), com_q.z());
+void WholeBodyStateDisplay::createGhosts(RobotInstance &robot) {
+  if (!settings_.ghost_enable || !initialized_model_ || !robot.root_node || !robot.ghosts.empty()) {
+    return;
+  }
+  Ogre::SceneManager *scene_manager = context_->getSceneManager();
+  for (std::size_t i = 0; i < settings_.ghost_count; ++i) {
+    boost::shared_ptr<GhostVisual> ghost(
+        new GhostVisual(scene_manager, scene_node_, *robot.robot, link_frames_, ghost_material_));
+    ghost->setVisualVisible(settings_.robot_visual_enable);
+    ghost->setCollisionVisible(settings_.robot_collision_enable);
+    robot.ghosts.push_back(ghost);
+  }
+  robot.visual_allocations += settings_.ghost_count;
+  clearGhosts(robot);
+}
 
-  // Now set or update the contents of the chosen CoM visual
-  updateCoMColorAndAlpha();
-  if (com_enable_ && std::isfinite(com_point.x) && std::isfinite(com_point.y) && std::isfinite(com_point.z)) {
-    com_visual_->setPoint(com_point);
-    com_visual_->setFramePosition(position);
-    com_visual_->setFrameOrientation(orientation);
-    const double &com_vel_norm = com_vel.norm();
-    const float &shaft_length = com_shaft_length_property_->getFloat() * com_vel_norm;
-    const float &shaft_radius = com_shaft_radius_property_->getFloat();
-    float head_length = 0., head_radius = 0.;
-    if (com_vel_norm > 0.01) {
-      head_length = com_head_length_property_->getFloat();
-      head_radius = com_head_radius_property_->getFloat();
-    }
-    comd_visual_->setProperties(shaft_length, shaft_radius, head_length, head_radius);
-    comd_visual_->setArrow(com_point, comd_for_orientation);
-    comd_visual_->setFramePosition(position);
-    comd_visual_->setFrameOrientation(orientation);
-  }
-
-  // Now set or update the contents of the chosen CoP visual
-  if (n_suppcontacts != 0) {
-    if (zmp_enable_) {
-      zmp_visual_.reset(new PointVisual(context_->getSceneManager(), scene_node_));
-    }
-    if (icp_enable_) {
-      icp_visual_.reset(new PointVisual(context_->getSceneManager(), scene_node_));
-    }
-    if (cmp_enable_) {
-      cmp_visual_.reset(new PointVisual(context_->getSceneManager(), scene_node_));
-    }
-
-    if (zmp_enable_ && std::isfinite(zmp_pos(0)) && std::isfinite(zmp_pos(1)) && std::isfinite(zmp_pos(2))) {
-      updateZMPColorAndAlpha();
-      Ogre::Vector3 cop_point(zmp_pos(0), zmp_pos(1), zmp_pos(2));
-      zmp_visual_->setPoint(cop_point);
-      zmp_visual_->setFramePosition(position);
-      zmp_visual_->setFrameOrientation(orientation);
-    }
-
-    // Computing the ICP
-    double height = abs(msg_->centroidal.com_position.z - zmp_pos(2));
-    double omega = sqrt(gravity_ / height);
-    Eigen::Vector3d com_pos = Eigen::Vector3d(msg_->centroidal.com_position.x, msg_->centroidal.com_position.y,
-                                              msg_->centroidal.com_position.z);
-    Eigen::Vector3d icp_pos = com_pos + com_vel / omega;
-    icp_pos(2) = zmp_pos(2);
-
-    // Now set or update the contents of the chosen Inst CP visual
-    if (icp_enable_ && std::isfinite(icp_pos(0)) && std::isfinite(icp_pos(1)) && std::isfinite(icp_pos(2))) {
-      updateICPColorAndAlpha();
-      Ogre::Vector3 icp_point(icp_pos(0), icp_pos(1), icp_pos(2));
-      icp_visual_->setPoint(icp_point);
-      icp_visual_->setFramePosition(position);
-      icp_visual_->setFrameOrientation(orientation);
-    }
-
-    // Computing the CMP
-    Eigen::Vector3d cmp_pos;
-    cmp_pos(0) = com_pos(0) - total_force(0) / total_force(2) * height;
-    cmp_pos(1) = com_pos(1) - total_force(1) / total_force(2) * height;
-    cmp_pos(2) = com_pos(2) - height;
-    if (cmp_enable_ && std::isfinite(cmp_pos(0)) && std::isfinite(cmp_pos(1)) && std::isfinite(cmp_pos(2))) {
-      updateCMPColorAndAlpha();
-      Ogre::Vector3 cmp_point(cmp_pos(0), cmp_pos(1), cmp_pos(2));
-      cmp_visual_->setPoint(cmp_point);
-      cmp_visual_->setFramePosition(position);
-      cmp_visual_->setFrameOrientation(orientation);
+void WholeBodyStateDisplay::clearGhosts(RobotInstance &robot) {
+  for (std::size_t i = 0; i < robot.ghosts.size(); ++i) {
+    robot.ghosts[i]->setVisible(false);
+  }
+  robot.next_ghost = 0;
+  robot.ghost_time = -std::numeric_limits<double>::infinity();
+}
+
+void WholeBodyStateDisplay::destroyGhosts(RobotInstance &robot) {
+  robot.ghosts.clear();
+  clearGhosts(robot);
+}
+
+void WholeBodyStateDisplay::clearTrails(RobotInstance &robot) {
+  if (!robot.com_trail) {
+    return;
+  }
+  robot.com_trail->clear();
+  robot.zmp_trail->clear();
+  robot.icp_trail->clear();
+  robot.cmp_trail->clear();
+  for (std::size_t i = 0; i < robot.cop_trail.size(); ++i) {
+    robot.cop_trail[i]->clear();
+  }
+}
+
+void WholeBodyStateDisplay::applyRenderLevel() {
+  // The visuals replaced by the current level are hidden, while the other ones are shown again by the next snapshot
+  const RenderBudget::Level level = render_budget_.getLevel();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    RobotInstance &robot = *robots_[i];
+    if (!robot.net_grf_visual) {
+      continue;
+    }
+    if (level >= RenderBudget::MERGED_FORCES) {
+      robot.grf_visual.setVisible(false);
+    } else {
+      robot.net_grf_visual->setVisible(false);
     }
+  }
+  settings_.dirty |= Settings::CONE_APPEARANCE | Settings::SNAPSHOT_GEOMETRY;
+  context_->queueRender();
+
+  const double budget = render_budget_.getBudget() * 1e3;
+  if (budget == 0.) {
+    return;
+  }
+  const QString level_name = RenderBudget::getLevelName(level);
+  if (level == RenderBudget::FULL) {
+    setStatus(StatusProperty::Ok, "Render Budget", level_name + QString(" within the %1 ms budget").arg(budget));
   } else {
-    if (zmp_visual_) {
-      zmp_visual_.reset();
+    setStatus(StatusProperty::Warn, "Render Budget",
+              level_name + QString(", since the frame cost of %1 ms exceeded the %2 ms budget")
+                               .arg(render_budget_.getTriggerCost() * 1e3, 0, 'f', 2)
+                               .arg(budget));
+  }
+}
+
+void WholeBodyStateDisplay::applySettings(unsigned int groups) {
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    applySettings(*robots_[i], groups);
+  }
+}
+
+void WholeBodyStateDisplay::applySettings(RobotInstance &robot, unsigned int groups) {
+  if (!robot.com_visual) {
+    return;
+  }
+  if (groups & Settings::COM_APPEARANCE) {
+    const Ogre::ColourValue &color = settings_.com.color;
+    robot.com_visual->setColor(color.r, color.g, color.b, color.a);
+    robot.com_visual->setRadius(settings_.com.radius);
+    robot.comd_visual->setColor(color.r, color.g, color.b, color.a);
+    setTrailAppearance(*robot.com_trail, settings_.com);
+  }
+  if (groups & Settings::ZMP_APPEARANCE) {
+    setPointAppearance(*robot.zmp_visual, settings_.zmp);
+    setTrailAppearance(*robot.zmp_trail, settings_.zmp);
+  }
+  if (groups & Settings::ICP_APPEARANCE) {
+    setPointAppearance(*robot.icp_visual, settings_.icp);
+    setTrailAppearance(*robot.icp_trail, settings_.icp);
+  }
+  if (groups & Settings::CMP_APPEARANCE) {
+    setPointAppearance(*robot.cmp_visual, settings_.cmp);
+    setTrailAppearance(*robot.cmp_trail, settings_.cmp);
+  }
+  if (groups & Settings::COP_APPEARANCE) {
+    for (std::size_t i = 0; i < robot.cop_visual.size(); ++i) {
+      setPointAppearance(*robot.cop_visual[i], settings_.cop);
     }
-    if (icp_visual_) {
-      icp_visual_.reset();
+    for (std::size_t i = 0; i < robot.cop_trail.size(); ++i) {
+      setTrailAppearance(*robot.cop_trail[i], settings_.cop);
     }
-    if (cmp_visual_) {
-      cmp_visual_.reset();
+  }
+  if (groups & Settings::GRF_APPEARANCE) {
+    const Ogre::ColourValue &color = settings_.grf_color;
+    for (std::size_t i = 0; i < robot.grf_visual.size(); ++i) {
+      robot.grf_visual[i]->setColor(color.r, color.g, color.b, color.a);
     }
+    robot.net_grf_visual->setColor(color.r, color.g, color.b, color.a);
   }
-
-  // Now set or update the contents of the chosen CoP visual
-  if (support_enable_) {
-    support_visual_->setVertices(support);
-    updateSupportLineColorAndAlpha();
-    updateSupportMeshColorAndAlpha();
-    support_visual_->setFramePosition(position);
-    support_visual_->setFrameOrientation(orientation);
+  if (groups & Settings::SUPPORT_LINE_APPEARANCE) {
+    const Ogre::ColourValue &color = settings_.support_line_color;
+    robot.support_visual->setLineColor(color.r, color.g, color.b, color.a);
+    robot.support_visual->setLineRadius(settings_.support_line_radius);
+  }
+  if (groups & Settings::SUPPORT_MESH_APPEARANCE) {
+    const Ogre::ColourValue &color = settings_.support_mesh_color;
+    robot.support_visual->setMeshColor(color.r, color.g, color.b, color.a);
+  }
+  if (groups & Settings::CONE_APPEARANCE) {
+    const Ogre::ColourValue &color = settings_.cone_color;
+    const bool wireframe = render_budget_.getLevel() >= RenderBudget::SIMPLE_CONES;
+    for (std::size_t i = 0; i < robot.cones_visual.size(); ++i) {
+      robot.cones_visual[i]->setColor(color.r, color.g, color.b, color.a);
+      robot.cones_visual[i]->setWireframe(wireframe);
+    }
+  }
+  if (groups & Settings::TRAIL_HISTORY) {
+    // Changing the capacity reallocates the trails, which then restart empty
+    std::vector<TrailVisual *> trails = {robot.com_trail.get(), robot.zmp_trail.get(), robot.icp_trail.get(),
+                                         robot.cmp_trail.get()};
+    for (std::size_t i = 0; i < robot.cop_trail.size(); ++i) {
+      trails.push_back(robot.cop_trail[i].get());
+    }
+    for (std::size_t i = 0; i < trails.size(); ++i) {
+      trails[i]->setDuration(settings_.trail_duration);
+      trails[i]->setCapacity(settings_.trail_capacity);
+      trails[i]->setVisible(settings_.trail_enable);
+    }
   }
 }
 
 void WholeBodyStateDisplay::update(float wall_dt, float /*ros_dt*/) {
-  if (has_new_msg_) {
-    processWholeBodyState();
-    has_new_msg_ = false;
+  // The messages held by the latest-only policy are released once per frame, and the latest transforms expire
+  input_filter_.flush();
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    robots_[i]->input_filter.flush();
+  }
+  transform_cache_.expireLatest();
+  handOffRobotModel();
+
+  // The settings changed since the last frame are pushed to the visuals, while the geometry scaled by the snapshot
+  // requires to apply it again
+  const unsigned int dirty = settings_.dirty;
+  settings_.dirty = 0;
+  applySettings(dirty);
+
+  // The snapshots are computed in parallel by the processing threads of the robots, and only the latest one of each
+  // robot is applied in a single pass
+  const std::size_t visual_allocations = getVisualAllocations();
+  const ros::WallTime apply_start = ros::WallTime::now();
+  bool applied = false;
+  const ros::Time display_time(std::max(ros::Time::now().toSec() - settings_.interpolation_delay, 0.));
+  for (std::size_t i = 0; i < robots_.size(); ++i) {
+    RobotInstance &robot = *robots_[i];
+    if (settings_.interpolation_delay > 0. && receiveSnapshot(robot, display_time)) {
+      applySnapshot(robot, true);
+      applied = true;
+    } else if (settings_.interpolation_delay == 0. && robot.processor.getSnapshot(robot.snapshot)) {
+      robot.has_snapshot = true;
+      ++processed_messages_;
+      applySnapshot(robot, true);
+      applied = true;
+    } else if (dirty & Settings::SNAPSHOT_GEOMETRY) {
+      applySnapshot(robot, false);
+    } else if (settings_.track_transform) {
+      // The geometry of the snapshot is kept, and only the root node follows the latest transform
+      poseRobot(robot, true);
+    }
+  }
+
+  // The cost of applying the snapshots selects the level of detail of the contact overlays for the next frames
+  if (applied) {
+    render_budget_.recordCost((ros::WallTime::now() - apply_start).toSec());
+  }
+  if (render_budget_.update(wall_dt)) {
+    applyRenderLevel();
+  }
+
+  // Reporting the visuals allocated by the last snapshots, which are zero in a steady-state stream
+  const std::size_t new_visual_allocations = getVisualAllocations() - visual_allocations;
+  if (applied && new_visual_allocations != last_visual_allocations_) {
+    setStatus(StatusProperty::Ok, "Visuals",
+              QString::number(new_visual_allocations) + " visuals allocated in the last frame");
+    last_visual_allocations_ = new_visual_allocations;
+  }
+
+  // The input counters, transform cache statistics and stage timings are reported once per second
+  status_elapsed_ += wall_dt;
+  if (status_elapsed_ >= 1.) {
+    status_elapsed_ = 0.;
+    // The counters are summed over the topics of all the robots
+    std::size_t received = input_filter_.getReceived();
+    std::size_t dropped = input_filter_.getDropped();
+    for (std::size_t i = 0; i < robots_.size(); ++i) {
+      received += robots_[i]->input_filter.getReceived();
+      dropped += robots_[i]->input_filter.getDropped();
+    }
+    setStatus(StatusProperty::Ok, "Input",
+              QString("%1 received, %2 dropped, %3 processed").arg(received).arg(dropped).arg(processed_messages_));
+    setStatus(StatusProperty::Ok, "Transforms",
+              QString("%1 cache hits, %2 misses").arg(transform_cache_.getHits()).arg(transform_cache_.getMisses()));
+    if (profiler_.isEnabled()) {
+      setStatusStd(StatusProperty::Ok, "Performance", profiler_.report(ros::WallTime::now().toSec()));
+    }
   }
 }
 
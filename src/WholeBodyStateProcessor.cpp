@@ -0,0 +1,317 @@
+///////////////////////////////////////////////////////////////////////////////
+// BSD 3-Clause License
+//
+// Copyright (C) 2023, Heriot-Watt University
+// Copyright note valid unless otherwise stated in individual files.
+// All rights reserved.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "whole_body_state_rviz_plugin/WholeBodyStateProcessor.h"
+#include <cmath>
+#include <pinocchio/algorithm/center-of-mass.hpp>
+#include <pinocchio/algorithm/kinematics.hpp>
+
+namespace whole_body_state_rviz_plugin {
+
+WholeBodyStateProcessor::WholeBodyStateProcessor()
+    : has_posture_(false),
+      posture_id_(0),
+      gravity_(9.81),
+      weight_(0.),
+      profiler_(nullptr),
+      has_ready_snapshot_(false),
+      stop_(false) {}
+
+WholeBodyStateProcessor::~WholeBodyStateProcessor() { stop(); }
+
+void WholeBodyStateProcessor::setModel(const boost::shared_ptr<const pinocchio::Model> &model) {
+  boost::mutex::scoped_lock model_lock(model_mutex_);
+  model_ = model;
+  data_ = pinocchio::Data(*model_);
+  joint_mapper_.setModel(*model_);
+  link_frames_.setModel(*model_);
+  q_.resize(model_->nq);
+  has_posture_ = false;
+  gravity_ = model_->gravity.linear().norm();
+  weight_ = pinocchio::computeTotalMass(*model_) * gravity_;
+
+  // Snapshots of the previous model are not valid anymore
+  boost::mutex::scoped_lock queue_lock(queue_mutex_);
+  pending_msg_.reset();
+  has_ready_snapshot_ = false;
+}
+
+void WholeBodyStateProcessor::setProfiler(StageProfiler *profiler) { profiler_ = profiler; }
+
+void WholeBodyStateProcessor::clear() {
+  boost::mutex::scoped_lock model_lock(model_mutex_);
+  model_.reset();
+  data_ = pinocchio::Data();
+  joint_mapper_.clear();
+  link_frames_.clear();
+  q_.resize(0);
+  has_posture_ = false;
+
+  boost::mutex::scoped_lock queue_lock(queue_mutex_);
+  pending_msg_.reset();
+  has_ready_snapshot_ = false;
+}
+
+void WholeBodyStateProcessor::start() {
+  if (thread_.joinable()) {
+    return;
+  }
+  stop_ = false;
+  thread_ = boost::thread(&WholeBodyStateProcessor::run, this);
+}
+
+void WholeBodyStateProcessor::stop() {
+  {
+    boost::mutex::scoped_lock lock(queue_mutex_);
+    stop_ = true;
+  }
+  queue_condition_.notify_one();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  boost::mutex::scoped_lock lock(queue_mutex_);
+  pending_msg_.reset();
+  has_ready_snapshot_ = false;
+}
+
+void WholeBodyStateProcessor::submit(const whole_body_state_msgs::WholeBodyState::ConstPtr &msg,
+                                     const ProcessingParameters &params) {
+  {
+    boost::mutex::scoped_lock lock(queue_mutex_);
+    pending_msg_ = msg;
+    pending_params_ = params;
+  }
+  queue_condition_.notify_one();
+}
+
+bool WholeBodyStateProcessor::getSnapshot(WholeBodyStateSnapshot &snapshot) {
+  boost::mutex::scoped_lock lock(queue_mutex_);
+  if (!has_ready_snapshot_) {
+    return false;
+  }
+  std::swap(ready_snapshot_, snapshot);
+  has_ready_snapshot_ = false;
+  return true;
+}
+
+bool WholeBodyStateProcessor::process(const whole_body_state_msgs::WholeBodyState &msg,
+                                      const ProcessingParameters &params, WholeBodyStateSnapshot &snapshot) {
+  boost::mutex::scoped_lock lock(model_mutex_);
+  return compute(msg, params, snapshot);
+}
+
+void WholeBodyStateProcessor::run() {
+  whole_body_state_msgs::WholeBodyState::ConstPtr msg;
+  ProcessingParameters params;
+  while (true) {
+    {
+      boost::mutex::scoped_lock lock(queue_mutex_);
+      while (!stop_ && !pending_msg_) {
+        queue_condition_.wait(lock);
+      }
+      if (stop_) {
+        return;
+      }
+      msg.swap(pending_msg_);
+      params = pending_params_;
+    }
+
+    // The model mutex is held until the snapshot is published, so a model change discards it
+    boost::mutex::scoped_lock model_lock(model_mutex_);
+    if (compute(*msg, params, work_snapshot_)) {
+      boost::mutex::scoped_lock queue_lock(queue_mutex_);
+      std::swap(work_snapshot_, ready_snapshot_);
+      has_ready_snapshot_ = true;
+    }
+    msg.reset();
+  }
+}
+
+bool WholeBodyStateProcessor::compute(const whole_body_state_msgs::WholeBodyState &msg,
+                                      const ProcessingParameters &params, WholeBodyStateSnapshot &snapshot) {
+  // Checking if the urdf model was initialized
+  if (!model_) {
+    return false;
+  }
+  snapshot.frame_id = msg.header.frame_id;
+  snapshot.stamp = msg.header.stamp;
+
+  // Computing the placements of the robot frames
+  snapshot.has_robot = params.robot_enable;
+  if (params.robot_enable) {
+    StageProfiler::ScopedTimer timer(profiler_, StageProfiler::FORWARD_KINEMATICS);
+    joint_mapper_.fillConfiguration(msg, q_);
+
+    // The CoM offset only depends on the posture, which is the configuration with the base at the origin
+    const bool same_posture = has_posture_ && (q_ - q_posture_).cwiseAbs().maxCoeff() <= params.posture_tolerance;
+    if (!same_posture) {
+      pinocchio::centerOfMass(*model_, data_, q_);
+      com_offset_ = data_.com[0];
+      q_posture_ = q_;
+    }
+    const Eigen::Vector3d com_position(msg.centroidal.com_position.x, msg.centroidal.com_position.y,
+                                       msg.centroidal.com_position.z);
+    const Eigen::Vector3d base_position = com_position - com_offset_;
+    const Eigen::Vector3d base_displacement = base_position - base_position_;
+
+    // The kinematics only run for a new posture, and the CoM computation already ran them with the base at the
+    // origin. Therefore, the link placements are shifted by the base position, as for a base displacement.
+    if (!same_posture) {
+      link_frames_.computePlacements(*model_, data_, link_placements_);
+      for (std::size_t i = 0; i < link_placements_.size(); ++i) {
+        link_placements_[i].translation() += base_position;
+      }
+      base_position_ = base_position;
+      has_posture_ = true;
+      ++posture_id_;
+    } else if (base_displacement.cwiseAbs().maxCoeff() > params.posture_tolerance) {
+      for (std::size_t i = 0; i < link_placements_.size(); ++i) {
+        link_placements_[i].translation() += base_displacement;
+      }
+      base_position_ = base_position;
+      ++posture_id_;
+    }
+    snapshot.frame_placements = link_placements_;
+    snapshot.posture_id = posture_id_;
+  }
+
+  // Computing the contact quantities over all the contacts at once
+  StageProfiler::ScopedTimer contact_timer(profiler_, StageProfiler::CONTACT_LOOP);
+  contact_frames_.fill(msg.contacts);
+  computeRotationsFromTwoVectors(Eigen::Vector3d::UnitZ(), contact_frames_.normals, contact_orientations_);
+  computeRotationsFromTwoVectors(-Eigen::Vector3d::UnitZ(), contact_frames_.forces, force_orientations_);
+  computeRotationsFromTwoVectors(-Eigen::Vector3d::UnitY(), contact_frames_.normals, cone_orientations_);
+  computeCentersOfPressure(contact_frames_.forces, contact_frames_.torques, cops_);
+  force_norms_ = contact_frames_.forces.colwise().norm().transpose();
+  normal_norms_ = contact_frames_.normals.colwise().norm().transpose();
+
+  const std::size_t num_contacts = contact_frames_.size();
+  std::size_t n_suppcontacts = 0;
+  snapshot.contacts.resize(num_contacts);
+  snapshot.support.clear();
+  Eigen::Vector3d zmp_pos = Eigen::Vector3d::Zero();
+  Eigen::Vector3d total_force = Eigen::Vector3d::Zero();
+  Eigen::Vector3d net_force = Eigen::Vector3d::Zero();
+  Eigen::Vector3d net_force_position = Eigen::Vector3d::Zero();
+  double net_force_weight = 0.;
+  for (std::size_t i = 0; i < num_contacts; ++i) {
+    ContactSnapshot &contact_snapshot = snapshot.contacts[i];
+    contact_snapshot.position = contact_frames_.positions.col(i);
+    contact_snapshot.orientation.coeffs() = contact_orientations_.col(i);
+    contact_snapshot.cop = cops_.col(i);
+
+    // Getting the contact status
+    const double force_norm = force_norms_(i);
+    const bool active_by_force = force_norm > params.force_threshold;
+    const bool active_by_status = contact_frames_.status[i] & ContactFrames::ACTIVE;
+    const bool is_locomotion = contact_frames_.status[i] & ContactFrames::LOCOMOTION;
+
+    // Updating the ZMP
+    const bool active_contact_in_zmp = params.use_contact_status_in_zmp ? active_by_status : active_by_force;
+    if (is_locomotion && active_contact_in_zmp) {
+      zmp_pos += contact_frames_.forces(2, i) * contact_snapshot.position;
+      total_force += contact_frames_.forces.col(i);
+      if (force_norm != 0) {
+        n_suppcontacts += 1;
+      }
+    }
+
+    // Center of pressure per contact. Mainly targets surface contacts (relatively meaningless for point contacts)
+    const bool active_contact_in_cop = params.use_contact_status_in_cop ? active_by_status : active_by_force;
+    const bool is_contact_6d = std::abs(contact_frames_.torques(0, i)) > params.torque_threshold ||
+                               std::abs(contact_frames_.torques(1, i)) > params.torque_threshold;
+    contact_snapshot.cop_visible = active_contact_in_cop && is_contact_6d && contact_snapshot.cop.allFinite();
+    const bool at_cop = params.cop_enable && active_contact_in_cop && is_contact_6d;
+
+    // Building the contact force and support polygon
+    contact_snapshot.grf_visible = false;
+    contact_snapshot.grf_at_cop = false;
+    if (contact_snapshot.position.allFinite()) {
+      contact_snapshot.force_orientation.coeffs() = force_orientations_.col(i);
+      contact_snapshot.force_ratio = force_norm / weight_;
+      const bool active_contact_in_grf = params.use_contact_status_in_grf ? active_by_status : active_by_force;
+      contact_snapshot.grf_visible = active_contact_in_grf && std::isfinite(contact_snapshot.force_ratio);
+      contact_snapshot.grf_at_cop = params.grf_locate_at_cop && at_cop;
+      if (contact_snapshot.grf_visible) {
+        net_force += contact_frames_.forces.col(i);
+        net_force_position += force_norm * contact_snapshot.position;
+        net_force_weight += force_norm;
+      }
+
+      const bool active_contact_in_support =
+          params.use_contact_status_in_support ? active_by_status : active_by_force;
+      if (active_contact_in_support && is_locomotion) {
+        snapshot.support.push_back(contact_snapshot.position);
+      }
+    }
+
+    // Building the friction cones
+    const bool active_contact_in_cone =
+        params.use_contact_status_in_friction_cone ? active_by_status : active_by_force;
+    contact_snapshot.friction_mu = contact_frames_.friction_coefficients(i);
+    contact_snapshot.cone_visible =
+        active_contact_in_cone && normal_norms_(i) != 0 && contact_snapshot.friction_mu != 0;
+    contact_snapshot.cone_at_cop = params.friction_cone_locate_at_cop && at_cop;
+    contact_snapshot.cone_orientation.coeffs() = cone_orientations_.col(i);
+  }
+
+  contact_timer.stop();
+
+  // Computing the net contact force, which replaces the contact forces when the display degrades its level of detail
+  snapshot.net_force_ratio = net_force.norm() / weight_;
+  snapshot.net_force_visible = net_force_weight > 0. && std::isfinite(snapshot.net_force_ratio);
+  if (snapshot.net_force_visible) {
+    snapshot.net_force_position = net_force_position / net_force_weight;
+    snapshot.net_force_orientation.setFromTwoVectors(-Eigen::Vector3d::UnitZ(), net_force);
+  }
+
+  // Computing the ZMP
+  snapshot.has_support = n_suppcontacts != 0;
+  if (snapshot.has_support) {
+    zmp_pos /= total_force(2);
+  }
+  snapshot.zmp = zmp_pos;
+
+  // Computing the displayed center of mass
+  const Eigen::Vector3d com_pos(msg.centroidal.com_position.x, msg.centroidal.com_position.y,
+                                msg.centroidal.com_position.z);
+  if (!params.com_real && snapshot.has_support) {
+    Eigen::Vector3d cop_z = Eigen::Vector3d::Zero();
+    cop_z(2) = zmp_pos(2);
+    pinocchio::SE3::Quaternion q(msg.centroidal.base_orientation.w, msg.centroidal.base_orientation.x,
+                                 msg.centroidal.base_orientation.y, msg.centroidal.base_orientation.z);
+    Eigen::Vector3d rot_cop_z = q.matrix() * cop_z;
+    snapshot.com(0) = com_pos(0) + rot_cop_z(0);
+    snapshot.com(1) = com_pos(1) + rot_cop_z(1);
+    snapshot.com(2) = cop_z(2);
+  } else {
+    snapshot.com = com_pos;
+  }
+  snapshot.com_visible = snapshot.com.allFinite();
+
+  // Computing the center of mass velocity orientation
+  snapshot.com_velocity = Eigen::Vector3d(msg.centroidal.com_velocity.x, msg.centroidal.com_velocity.y,
+                                          msg.centroidal.com_velocity.z);
+  snapshot.com_velocity_orientation.setFromTwoVectors(-Eigen::Vector3d::UnitZ(), snapshot.com_velocity);
+
+  // Computing the ICP and CMP
+  if (snapshot.has_support) {
+    const double height = std::abs(com_pos(2) - zmp_pos(2));
+    const double omega = std::sqrt(gravity_ / height);
+    snapshot.icp = com_pos + snapshot.com_velocity / omega;
+    snapshot.icp(2) = zmp_pos(2);
+
+    snapshot.cmp(0) = com_pos(0) - total_force(0) / total_force(2) * height;
+    snapshot.cmp(1) = com_pos(1) - total_force(1) / total_force(2) * height;
+    snapshot.cmp(2) = com_pos(2) - height;
+  }
+  return true;
+}
+
+}  // namespace whole_body_state_rviz_plugin
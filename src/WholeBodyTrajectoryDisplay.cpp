@@ -8,13 +8,15 @@
 
 #include "whole_body_state_rviz_plugin/WholeBodyTrajectoryDisplay.h"
 #include "whole_body_state_rviz_plugin/PinocchioLinkUpdater.h"
+#include "whole_body_state_rviz_plugin/RobotModelCache.h"
 #include <Eigen/Dense>
 #include <OgreManualObject.h>
 #include <OgreSceneManager.h>
 #include <OgreSceneNode.h>
 #include <QTimer>
+#include <algorithm>
 #include <pinocchio/algorithm/center-of-mass.hpp>
-#include <pinocchio/parsers/urdf.hpp>
+#include <pinocchio/algorithm/kinematics.hpp>
 
 using namespace rviz;
 
@@ -27,12 +29,8 @@ void linkUpdaterStatusFunction(rviz::StatusLevel level, const std::string &link_
 
 WholeBodyTrajectoryDisplay::WholeBodyTrajectoryDisplay()
     : has_new_msg_(false),
-      weight_(0.),
-      target_enable_(true),
-      com_enable_(true),
-      com_axes_enable_(true),
-      contact_enable_(true),
-      contact_axes_enable_(true) {
+      status_elapsed_(0.),
+      weight_(0.) {
   // Category Groups
   target_category_ = new rviz::Property("Target", QVariant(), "", this);
   com_category_ = new rviz::Property("Center of Mass", QVariant(), "", this);
@@ -90,6 +88,10 @@ WholeBodyTrajectoryDisplay::WholeBodyTrajectoryDisplay()
                                           SLOT(updateCoMLineProperties()), this);
   com_scale_property_ = new FloatProperty("Axes Scale", 1.0, "The scale of the axes that describe the orientation.",
                                           com_category_, SLOT(updateCoMLineProperties()), this);
+  com_axes_max_property_ =
+      new IntProperty("Axes Max Count", 100, "Maximum number of axes drawn along the trajectory.", com_category_,
+                      SLOT(updateCoMLineProperties()), this);
+  com_axes_max_property_->setMin(0);
   com_alpha_property_ = new FloatProperty("Alpha", 1.0, "Amount of transparency to apply to the trajectory.",
                                           com_category_, SLOT(updateCoMLineProperties()), this);
   com_alpha_property_->setMin(0);
@@ -115,10 +117,23 @@ WholeBodyTrajectoryDisplay::WholeBodyTrajectoryDisplay()
   contact_scale_property_ =
       new FloatProperty("Axes Scale", 1.0, "The scale of the axes that describe the orientation.", contact_category_,
                         SLOT(updateContactLineProperties()), this);
+  contact_axes_max_property_ =
+      new IntProperty("Axes Max Count", 100, "Maximum number of axes drawn along each trajectory.",
+                      contact_category_, SLOT(updateContactLineProperties()), this);
+  contact_axes_max_property_->setMin(0);
   contact_alpha_property_ = new FloatProperty("Alpha", 1.0, "Amount of transparency to apply to the trajectory.",
                                               contact_category_, SLOT(updateContactLineProperties()), this);
   contact_alpha_property_->setMin(0);
   contact_alpha_property_->setMax(1);
+
+  // Profiling properties
+  profiling_enable_property_ =
+      new BoolProperty("Profiling", false, "Report the time spent in each processing stage as a status.", this,
+                       SLOT(updateProfiling()), this);
+  profiling_csv_property_ = new StringProperty("CSV File", "",
+                                               "File where the statistics of the processing stages are dumped every "
+                                               "second. Nothing is dumped if it is empty.",
+                                               profiling_enable_property_, SLOT(updateProfiling()), this);
 }
 
 WholeBodyTrajectoryDisplay::~WholeBodyTrajectoryDisplay() {
@@ -129,9 +144,19 @@ WholeBodyTrajectoryDisplay::~WholeBodyTrajectoryDisplay() {
 void WholeBodyTrajectoryDisplay::onInitialize() {
   MFDClass::onInitialize();
   robot_.reset(new rviz::Robot(scene_node_, context_, "Robot: " + getName().toStdString(), this));
+  force_visual_.initialize(scene_manager_, scene_node_);
   updateRobotVisualVisible();
   updateRobotCollisionVisible();
   updateRobotAlpha();
+  updateProfiling();
+
+  // Mirroring the property values into the settings, which are only updated by the slots afterwards
+  updateForceColorAndAlpha();
+  updateForceArrowGeometry();
+  updateCoMStyle();
+  updateCoMLineProperties();
+  updateContactStyle();
+  updateContactLineProperties();
 }
 
 void WholeBodyTrajectoryDisplay::onEnable() {
@@ -145,22 +170,15 @@ void WholeBodyTrajectoryDisplay::onEnable() {
 void WholeBodyTrajectoryDisplay::onDisable() {
   MFDClass::onDisable();
   robot_->setVisible(false);
-  clearRobotModel();
-  // Remove all artefacts:
-  com_manual_object_.reset();
-  com_billboard_line_.reset();
-  com_points_.clear();
-  com_axes_.clear();
-  contact_manual_object_.clear();
-  contact_billboard_line_.clear();
-  contact_points_.clear();
-  contact_axes_.clear();
+  // Remove all artefacts, while the robot model is kept so enabling the display again does not load it
+  destroyObjects();
   force_visual_.clear();
   context_->queueRender();
 }
 
 void WholeBodyTrajectoryDisplay::fixedFrameChanged() {
   MFDClass::fixedFrameChanged();
+  transform_cache_.clear();
   if (msg_ != nullptr) {
     // Visualization of the base trajectory
     processCoMTrajectory();
@@ -169,27 +187,24 @@ void WholeBodyTrajectoryDisplay::fixedFrameChanged() {
   }
 }
 
-void WholeBodyTrajectoryDisplay::reset() { MFDClass::reset(); }
+void WholeBodyTrajectoryDisplay::reset() {
+  MFDClass::reset();
+  transform_cache_.clear();
+}
 
 void WholeBodyTrajectoryDisplay::updateCoMStyle() {
-  LineStyle style = (LineStyle)com_style_property_->getOptionInt();
-  switch (style) {
+  settings_.com.style = (LineStyle)com_style_property_->getOptionInt();
+  switch (settings_.com.style) {
     case BILLBOARDS:
+    case POINTS:
       com_line_width_property_->show();
-      com_manual_object_.reset();
-      com_points_.clear();
       break;
     case LINES:
       com_line_width_property_->hide();
-      com_billboard_line_.reset();
-      com_points_.clear();
-      break;
-    case POINTS:
-      com_line_width_property_->show();
-      com_manual_object_.reset();
-      com_billboard_line_.reset();
       break;
   }
+  // The geometry of the new style is built from scratch
+  com_geometry_ = SeriesGeometry();
   if (msg_ != nullptr) {
     processCoMTrajectory();
   }
@@ -215,223 +230,102 @@ void WholeBodyTrajectoryDisplay::updateRobotAlpha() {
 }
 
 void WholeBodyTrajectoryDisplay::updateForceColorAndAlpha() {
-  Ogre::ColourValue color = force_color_property_->getOgreColor();
-  color.a = force_alpha_property_->getFloat();
-  for (size_t i = 0; i < force_visual_.size(); ++i) {
-    force_visual_[i]->setColor(color.r, color.g, color.b, color.a);
-  }
+  settings_.force_color = force_color_property_->getOgreColor();
+  settings_.force_color.a = force_alpha_property_->getFloat();
+  settings_.dirty |= Settings::FORCE_APPEARANCE;
   context_->queueRender();
 }
 
 void WholeBodyTrajectoryDisplay::updateForceArrowGeometry() {
-  const float &shaft_length = force_shaft_length_property_->getFloat();
-  const float &shaft_radius = force_shaft_radius_property_->getFloat();
-  const float &head_length = force_head_length_property_->getFloat();
-  const float &head_radius = force_head_radius_property_->getFloat();
-  for (size_t i = 0; i < force_visual_.size(); ++i) {
-    force_visual_[i]->setProperties(shaft_length, shaft_radius, head_length, head_radius);
-  }
+  settings_.force_arrow.shaft_length = force_shaft_length_property_->getFloat();
+  settings_.force_arrow.shaft_radius = force_shaft_radius_property_->getFloat();
+  settings_.force_arrow.head_length = force_head_length_property_->getFloat();
+  settings_.force_arrow.head_radius = force_head_radius_property_->getFloat();
+  settings_.dirty |= Settings::FORCE_GEOMETRY;
   context_->queueRender();
 }
 
 void WholeBodyTrajectoryDisplay::updateTargetEnable() {
-  target_enable_ = target_enable_property_->getBool();
-  if (target_enable_) {
+  settings_.target_enable = target_enable_property_->getBool();
+  if (settings_.target_enable) {
     robot_->setVisible(true);
   } else {
     robot_->setVisible(false);
+    force_visual_.setVisible(false);
   }
 }
 
 void WholeBodyTrajectoryDisplay::updateCoMEnable() {
-  com_enable_ = com_enable_property_->getBool();
-  if (!com_enable_) {
-    com_billboard_line_.reset();
-    com_manual_object_.reset();
-    com_points_.clear();
+  settings_.com.enable = com_enable_property_->getBool();
+  if (!settings_.com.enable) {
+    com_geometry_ = SeriesGeometry();
   }
   context_->queueRender();
 }
 
 void WholeBodyTrajectoryDisplay::updateContactEnable() {
-  contact_enable_ = contact_enable_property_->getBool();
-  if (!contact_enable_) {
-    for (std::size_t i = 0; i < contact_manual_object_.size(); ++i) {
-      contact_manual_object_[i].reset();
-    }
-    for (std::size_t i = 0; i < contact_billboard_line_.size(); ++i) {
-      contact_billboard_line_[i].reset();
-    }
-    for (std::size_t i = 0; i < contact_points_.size(); ++i) {
-      std::size_t n_elems = contact_points_[i].size();
-      for (std::size_t j = 0; j < n_elems; ++j) contact_points_[i][j].reset();
-      contact_points_[i].clear();
-    }
+  settings_.contact.enable = contact_enable_property_->getBool();
+  if (!settings_.contact.enable) {
+    contact_geometry_.clear();
   }
   context_->queueRender();
 }
 
 void WholeBodyTrajectoryDisplay::updateCoMLineProperties() {
-  LineStyle style = (LineStyle)com_style_property_->getOptionInt();
-  float line_width = com_line_width_property_->getFloat();
-  float scale = com_scale_property_->getFloat();
-  com_axes_enable_ = true;
-  if (scale == 0) {
-    com_axes_enable_ = false;
-    com_axes_.clear();
-  }
-  Ogre::ColourValue color = com_color_property_->getOgreColor();
-  color.a = com_alpha_property_->getFloat();
-  if (style == BILLBOARDS) {
-    com_billboard_line_->setLineWidth(line_width);
-    com_billboard_line_->setColor(color.r, color.g, color.b, color.a);
-    if (com_axes_enable_) {
-      std::size_t num_axes = com_axes_.size();
-      for (std::size_t i = 0; i < num_axes; ++i) {
-        Ogre::ColourValue x_color = com_axes_[i]->getDefaultXColor();
-        Ogre::ColourValue y_color = com_axes_[i]->getDefaultYColor();
-        Ogre::ColourValue z_color = com_axes_[i]->getDefaultZColor();
-        x_color.a = com_alpha_property_->getFloat();
-        y_color.a = com_alpha_property_->getFloat();
-        z_color.a = com_alpha_property_->getFloat();
-        com_axes_[i]->setXColor(x_color);
-        com_axes_[i]->setYColor(y_color);
-        com_axes_[i]->setZColor(z_color);
-        com_axes_[i]->getSceneNode()->setVisible(true);
-        com_axes_[i]->setScale(Ogre::Vector3(scale, scale, scale));
-      }
-    }
-  } else if (style == LINES) {
-    // we have to process again the base trajectory
-    if (msg_ != nullptr) processCoMTrajectory();
-  } else {
-    std::size_t n_points = com_points_.size();
-    for (std::size_t i = 0; i < n_points; ++i) {
-      com_points_[i]->setColor(color.r, color.g, color.b, color.a);
-      com_points_[i]->setRadius(line_width);
-    }
-    if (com_axes_enable_) {
-      std::size_t num_axes = com_axes_.size();
-      for (std::size_t i = 0; i < num_axes; ++i) {
-        Ogre::ColourValue x_color = com_axes_[i]->getDefaultXColor();
-        Ogre::ColourValue y_color = com_axes_[i]->getDefaultYColor();
-        Ogre::ColourValue z_color = com_axes_[i]->getDefaultZColor();
-        x_color.a = com_alpha_property_->getFloat();
-        y_color.a = com_alpha_property_->getFloat();
-        z_color.a = com_alpha_property_->getFloat();
-        com_axes_[i]->setXColor(x_color);
-        com_axes_[i]->setYColor(y_color);
-        com_axes_[i]->setZColor(z_color);
-        com_axes_[i]->getSceneNode()->setVisible(true);
-        com_axes_[i]->setScale(Ogre::Vector3(scale, scale, scale));
-      }
-    }
-  }
+  SeriesSettings &settings = settings_.com;
+  settings.line_width = com_line_width_property_->getFloat();
+  settings.axes_scale = com_scale_property_->getFloat();
+  settings.axes_enable = settings.axes_scale != 0;
+  settings.axes_max = com_axes_max_property_->getInt();
+  settings.color = com_color_property_->getOgreColor();
+  settings.color.a = com_alpha_property_->getFloat();
+  settings_.dirty |= Settings::COM_APPEARANCE;
   context_->queueRender();
 }
 
 void WholeBodyTrajectoryDisplay::updateContactStyle() {
-  LineStyle style = (LineStyle)contact_style_property_->getOptionInt();
-  std::size_t n_contacts = contact_billboard_line_.size();
-  std::size_t n_points = contact_points_.size();
-  switch (style) {
+  settings_.contact.style = (LineStyle)contact_style_property_->getOptionInt();
+  switch (settings_.contact.style) {
     case BILLBOARDS:
+    case POINTS:
       contact_line_width_property_->show();
-      for (std::size_t i = 0; i < n_contacts; ++i) {
-        contact_manual_object_[i].reset();
-      }
-      for (std::size_t i = 0; i < n_points; ++i) {
-        std::size_t n_elems = contact_points_[i].size();
-        for (std::size_t j = 0; j < n_elems; ++j) contact_points_[i][j].reset();
-        contact_points_[i].clear();
-      }
       break;
     case LINES:
       contact_line_width_property_->hide();
-      for (std::size_t i = 0; i < n_contacts; ++i) {
-        contact_billboard_line_[i].reset();
-      }
-      for (std::size_t i = 0; i < n_points; ++i) {
-        std::size_t n_elems = contact_points_[i].size();
-        for (std::size_t j = 0; j < n_elems; ++j) contact_points_[i][j].reset();
-        contact_points_[i].clear();
-      }
       break;
-    case POINTS:
-      contact_line_width_property_->show();
-      for (std::size_t i = 0; i < n_contacts; ++i) {
-        contact_manual_object_[i].reset();
-        contact_billboard_line_[i].reset();
-      }
   }
+  // The geometry of the new style is built from scratch
+  contact_geometry_.clear();
   if (msg_ != nullptr) {
     processContactTrajectory();
   }
 }
 
 void WholeBodyTrajectoryDisplay::updateContactLineProperties() {
-  LineStyle style = (LineStyle)contact_style_property_->getOptionInt();
-  float line_width = contact_line_width_property_->getFloat();
-  Ogre::ColourValue color = contact_color_property_->getOgreColor();
-  float scale = contact_scale_property_->getFloat();
-  contact_axes_enable_ = true;
-  if (scale == 0) {
-    contact_axes_enable_ = false;
-    contact_axes_.clear();
+  SeriesSettings &settings = settings_.contact;
+  settings.line_width = contact_line_width_property_->getFloat();
+  settings.axes_scale = contact_scale_property_->getFloat();
+  settings.axes_enable = settings.axes_scale != 0;
+  settings.axes_max = contact_axes_max_property_->getInt();
+  settings.color = contact_color_property_->getOgreColor();
+  settings.color.a = contact_alpha_property_->getFloat();
+  settings_.dirty |= Settings::CONTACT_APPEARANCE;
+  context_->queueRender();
+}
+
+void WholeBodyTrajectoryDisplay::updateProfiling() {
+  const bool enable = profiling_enable_property_->getBool();
+  profiler_.setEnabled(enable);
+  if (!enable) {
+    deleteStatus("Performance");
   }
-  color.a = contact_alpha_property_->getFloat();
-  if (style == BILLBOARDS) {
-    std::size_t n_contacts = contact_billboard_line_.size();
-    for (std::size_t i = 0; i < n_contacts; ++i) {
-      contact_billboard_line_[i]->setLineWidth(line_width);
-      contact_billboard_line_[i]->setColor(color.r, color.g, color.b, color.a);
-    }
-    if (contact_axes_enable_) {
-      std::size_t num_axes = contact_axes_.size();
-      for (std::size_t i = 0; i < num_axes; ++i) {
-        Ogre::ColourValue x_color = contact_axes_[i]->getDefaultXColor();
-        Ogre::ColourValue y_color = contact_axes_[i]->getDefaultYColor();
-        Ogre::ColourValue z_color = contact_axes_[i]->getDefaultZColor();
-        x_color.a = contact_alpha_property_->getFloat();
-        y_color.a = contact_alpha_property_->getFloat();
-        z_color.a = contact_alpha_property_->getFloat();
-        contact_axes_[i]->setXColor(x_color);
-        contact_axes_[i]->setYColor(y_color);
-        contact_axes_[i]->setZColor(z_color);
-        contact_axes_[i]->getSceneNode()->setVisible(true);
-        contact_axes_[i]->setScale(Ogre::Vector3(scale, scale, scale));
-      }
-    }
-  } else if (style == LINES) {
-    // we have to process again the contact trajectory
-    if (msg_ != nullptr) processContactTrajectory();
-  } else {
-    std::size_t n_points = contact_points_.size();
-    for (std::size_t i = 0; i < n_points; ++i) {
-      std::size_t n_contacts = contact_points_[i].size();
-      for (std::size_t j = 0; j < n_contacts; ++j) {
-        contact_points_[i][j]->setColor(color.r, color.g, color.b, color.a);
-        contact_points_[i][j]->setRadius(line_width);
-      }
-    }
-    if (contact_axes_enable_) {
-      std::size_t num_axes = contact_axes_.size();
-      for (std::size_t i = 0; i < num_axes; ++i) {
-        Ogre::ColourValue x_color = contact_axes_[i]->getDefaultXColor();
-        Ogre::ColourValue y_color = contact_axes_[i]->getDefaultYColor();
-        Ogre::ColourValue z_color = contact_axes_[i]->getDefaultZColor();
-        x_color.a = contact_alpha_property_->getFloat();
-        y_color.a = contact_alpha_property_->getFloat();
-        z_color.a = contact_alpha_property_->getFloat();
-        contact_axes_[i]->setXColor(x_color);
-        contact_axes_[i]->setYColor(y_color);
-        contact_axes_[i]->setZColor(z_color);
-        contact_axes_[i]->getSceneNode()->setVisible(true);
-        contact_axes_[i]->setScale(Ogre::Vector3(scale, scale, scale));
-      }
-    }
+  profiler_.closeCsv();
+  deleteStatus("Performance CSV");
+  const std::string csv_file = profiling_csv_property_->getStdString();
+  if (enable && !csv_file.empty() && !profiler_.openCsv(csv_file)) {
+    setStatus(StatusProperty::Error, "Performance CSV",
+              "Failed to open [" + profiling_csv_property_->getString() + "]");
   }
-  context_->queueRender();
 }
 
 void WholeBodyTrajectoryDisplay::processMessage(const whole_body_state_msgs::WholeBodyTrajectory::ConstPtr &msg) {
@@ -441,9 +335,16 @@ void WholeBodyTrajectoryDisplay::processMessage(const whole_body_state_msgs::Who
 }
 
 void WholeBodyTrajectoryDisplay::update(float wall_dt, float /*ros_dt*/) {
+  transform_cache_.expireLatest();
+  handOffRobotModel();
+
+  // The settings changed since the last frame are pushed to the visuals
+  const unsigned int dirty = settings_.dirty;
+  settings_.dirty = 0;
+  applySettings(dirty);
+
   if (has_new_msg_) {
-    // Destroy all the old elements
-    destroyObjects();
+    // The elements of the previous message are updated in place
     // Visualization of the base trajectory
     processTargetPosture();
     // Visualization of the base trajectory
@@ -452,351 +353,217 @@ void WholeBodyTrajectoryDisplay::update(float wall_dt, float /*ros_dt*/) {
     processContactTrajectory();
     has_new_msg_ = false;
   }
+
+  // The transform cache statistics and stage timings are reported once per second
+  status_elapsed_ += wall_dt;
+  if (status_elapsed_ >= 1.) {
+    status_elapsed_ = 0.;
+    setStatus(StatusProperty::Ok, "Transforms",
+              QString("%1 cache hits, %2 misses").arg(transform_cache_.getHits()).arg(transform_cache_.getMisses()));
+    if (profiler_.isEnabled()) {
+      setStatusStd(StatusProperty::Ok, "Performance", profiler_.report(ros::WallTime::now().toSec()));
+    }
+  }
 }
 
 void WholeBodyTrajectoryDisplay::processTargetPosture() {
-  if (target_enable_) {
+  if (settings_.target_enable && model_ && !msg_->trajectory.empty()) {
     Ogre::Quaternion orientation;
     Ogre::Vector3 position;
-    if (!context_->getFrameManager()->getTransform(msg_->header.frame_id, msg_->header.stamp, position, orientation)) {
+    StageProfiler::ScopedTimer transform_timer(&profiler_, StageProfiler::TRANSFORM_LOOKUP);
+    const bool has_transform =
+        transform_cache_.getTransform(context_->getFrameManager(), msg_->header.frame_id, msg_->header.stamp, position,
+                                      orientation);
+    transform_timer.stop();
+    if (!has_transform) {
       ROS_DEBUG("Error transforming from frame '%s' to frame '%s'", msg_->header.frame_id.c_str(),
                 qPrintable(fixed_frame_));
       return;
     }
 
     const whole_body_state_msgs::WholeBodyState &state = msg_->trajectory.back();
-    Eigen::VectorXd q = Eigen::VectorXd::Zero(model_.nq);
-    q(3) = state.centroidal.base_orientation.x;
-    q(4) = state.centroidal.base_orientation.y;
-    q(5) = state.centroidal.base_orientation.z;
-    q(6) = state.centroidal.base_orientation.w;
-    std::size_t n_joints = state.joints.size();
-    for (std::size_t j = 0; j < n_joints; ++j) {
-      pinocchio::JointIndex jointId = model_.getJointId(state.joints[j].name) - 2;
-      q(jointId + 7) = state.joints[j].position;
+    StageProfiler::ScopedTimer fk_timer(&profiler_, StageProfiler::FORWARD_KINEMATICS);
+    Eigen::VectorXd q(model_->nq);
+    joint_mapper_.fillConfiguration(state, q);
+    pinocchio::centerOfMass(*model_, data_, q);
+    // The CoM computation already ran the kinematics with the base at the origin, so the link placements are shifted
+    // by the base position that matches the CoM of the message
+    const Eigen::Vector3d base_position(state.centroidal.com_position.x - data_.com[0](0),
+                                       state.centroidal.com_position.y - data_.com[0](1),
+                                       state.centroidal.com_position.z - data_.com[0](2));
+    link_frames_.computePlacements(*model_, data_, link_placements_);
+    for (std::size_t i = 0; i < link_placements_.size(); ++i) {
+      link_placements_[i].translation() += base_position;
     }
-    pinocchio::centerOfMass(model_, data_, q);
-    q(0) = state.centroidal.com_position.x - data_.com[0](0);
-    q(1) = state.centroidal.com_position.y - data_.com[0](1);
-    q(2) = state.centroidal.com_position.z - data_.com[0](2);
+    fk_timer.stop();
+    StageProfiler::ScopedTimer visual_timer(&profiler_, StageProfiler::VISUAL_UPDATE);
     robot_->setPosition(position);
     robot_->setOrientation(orientation);
-    robot_->update(PinocchioLinkUpdater(model_, data_, q, boost::bind(linkUpdaterStatusFunction, _1, _2, _3, this)));
+    robot_->update(PinocchioLinkUpdater(link_frames_, link_placements_,
+                                        boost::bind(linkUpdaterStatusFunction, _1, _2, _3, this)));
 
+    // We are keeping a pool of arrow visuals, which is only resized when the number of contacts changes
     size_t n_contacts = state.contacts.size();
-    force_visual_.clear();
+    if (force_visual_.resize(n_contacts)) {
+      applySettings(Settings::FORCE_APPEARANCE);
+    }
     for (size_t i = 0; i < n_contacts; ++i) {
       const whole_body_state_msgs::ContactState &contact = state.contacts[i];
+      const boost::shared_ptr<ArrowVisual> &arrow = force_visual_[i];
       // Getting the contact position
       Ogre::Vector3 contact_pos(contact.pose.position.x, contact.pose.position.y, contact.pose.position.z);
       // Getting the force direction
       Eigen::Vector3d for_ref_dir = -Eigen::Vector3d::UnitZ();
       Eigen::Vector3d for_dir(contact.wrench.force.x, contact.wrench.force.y, contact.wrench.force.z);
+      bool visible = false;
       if (for_dir.norm() > 0. && std::isfinite(contact_pos.x) && std::isfinite(contact_pos.y) &&
           std::isfinite(contact_pos.z)) {
         Eigen::Quaterniond for_q;
         for_q.setFromTwoVectors(for_ref_dir, for_dir);
         Ogre::Quaternion contact_for_orientation(for_q.w(), for_q.x(), for_q.y(), for_q.z());
-        // We are keeping a vector of visual pointers. This creates the next
-        // one and stores it in the vector
-        boost::shared_ptr<ArrowVisual> arrow;
-        arrow.reset(new ArrowVisual(context_->getSceneManager(), scene_node_));
         arrow->setArrow(contact_pos, contact_for_orientation);
         arrow->setFramePosition(position);
         arrow->setFrameOrientation(orientation);
-        // Setting the arrow color and properties
-        Ogre::ColourValue color = force_color_property_->getOgreColor();
-        color.a = force_alpha_property_->getFloat();
-        arrow->setColor(color.r, color.g, color.b, color.a);
-        const float &shaft_length = force_shaft_length_property_->getFloat() * for_dir.norm() / weight_;
-        const float &shaft_radius = force_shaft_radius_property_->getFloat();
-        const float &head_length = force_head_length_property_->getFloat();
-        const float &head_radius = force_head_radius_property_->getFloat();
+        // Setting the arrow properties
+        const float shaft_length = settings_.force_arrow.shaft_length * for_dir.norm() / weight_;
+        const float &shaft_radius = settings_.force_arrow.shaft_radius;
+        const float &head_length = settings_.force_arrow.head_length;
+        const float &head_radius = settings_.force_arrow.head_radius;
         arrow->setProperties(shaft_length, shaft_radius, head_length, head_radius);
-        // And send it to the end of the vector
-        if (std::isfinite(shaft_length) && std::isfinite(shaft_radius) && std::isfinite(head_length) &&
-            std::isfinite(head_radius)) {
-          force_visual_.push_back(arrow);
-        }
+        // And show it only if it is well defined
+        visible = std::isfinite(shaft_length) && std::isfinite(shaft_radius) && std::isfinite(head_length) &&
+                  std::isfinite(head_radius);
       }
+      arrow->setVisible(visible);
     }
   }
 }
 
 void WholeBodyTrajectoryDisplay::processCoMTrajectory() {
   // Lookup transform into fixed frame
-  if (com_enable_) {
+  if (settings_.com.enable) {
     Ogre::Vector3 position;
     Ogre::Quaternion orientation;
-    if (!context_->getFrameManager()->getTransform(msg_->header, position, orientation)) {
+    StageProfiler::ScopedTimer transform_timer(&profiler_, StageProfiler::TRANSFORM_LOOKUP);
+    const bool has_transform = transform_cache_.getTransform(context_->getFrameManager(), msg_->header.frame_id,
+                                                             msg_->header.stamp, position, orientation);
+    transform_timer.stop();
+    if (!has_transform) {
       ROS_DEBUG("Error transforming from frame '%s' to frame '%s'", msg_->header.frame_id.c_str(),
                 qPrintable(fixed_frame_));
     }
-    Ogre::Matrix4 transform(orientation);
-    transform.setTrans(position);
-
-    // Visualization of the base trajectory
-    // Getting the base trajectory style
-    LineStyle base_style = (LineStyle)com_style_property_->getOptionInt();
 
-    // Getting the base trajectory color
-    Ogre::ColourValue base_color = com_color_property_->getOgreColor();
-    base_color.a = com_alpha_property_->getFloat();
+    // Sampling the base trajectory in the fixed frame
+    sampleCoMTrajectory(msg_->trajectory, Eigen::Vector3d(position.x, position.y, position.z),
+                        Eigen::Quaterniond(orientation.w, orientation.x, orientation.y, orientation.z), com_knots_);
 
-    // Visualization of the base trajectory
-    std::size_t n_points = msg_->trajectory.size();
-    com_axes_.clear();
-    for (std::size_t i = 0; i < n_points; ++i) {
-      const whole_body_state_msgs::WholeBodyState &state = msg_->trajectory[i];
-      // Obtaining the CoM position and the base orientation
-      Ogre::Vector3 com_position;
-      Ogre::Quaternion base_orientation;
-      com_position.x = state.centroidal.com_position.x;
-      com_position.y = state.centroidal.com_position.y;
-      com_position.z = state.centroidal.com_position.z;
-      base_orientation.x = state.centroidal.base_orientation.x;
-      base_orientation.y = state.centroidal.base_orientation.y;
-      base_orientation.z = state.centroidal.base_orientation.z;
-      base_orientation.w = state.centroidal.base_orientation.w;
-      // sanity checks
-      if (!(std::isfinite(com_position.x) && std::isfinite(com_position.y) && std::isfinite(com_position.z))) {
-        std::cerr << "CoM position is not finite, resetting to zero" << std::endl;
-        com_position.x = 0.0;
-        com_position.y = 0.0;
-        com_position.z = 0.0;
-      }
-      if (!(std::isfinite(base_orientation.x) && std::isfinite(base_orientation.y) &&
-            std::isfinite(base_orientation.z) && std::isfinite(base_orientation.w))) {
-        std::cerr << "Body orientation is not finite, resetting to [0 0 0 1]" << std::endl;
-        base_orientation.x = 0.;
-        base_orientation.y = 0.;
-        base_orientation.z = 0.;
-        base_orientation.w = 1.;
-      }
-
-      Ogre::Vector3 point_position = transform * com_position;
-      if (com_axes_enable_) {
-        pushBackCoMAxes(point_position, base_orientation * orientation);
-      }
-      switch (base_style) {
-        case BILLBOARDS: {
-          // Getting the base line width
-          if (i == 0) {
-            float base_line_width = com_line_width_property_->getFloat();
-            com_billboard_line_.reset(new rviz::BillboardLine(scene_manager_, scene_node_));
-            com_billboard_line_->setNumLines(1);
-            com_billboard_line_->setMaxPointsPerLine(n_points);
-            com_billboard_line_->setLineWidth(base_line_width);
-          }
-          com_billboard_line_->addPoint(point_position, base_color);
-        } break;
-        case LINES: {
-          if (i == 0) {
-            com_manual_object_.reset(scene_manager_->createManualObject());
-            com_manual_object_->setDynamic(true);
-            scene_node_->attachObject(com_manual_object_.get());
-            com_manual_object_->estimateVertexCount(n_points);
-            com_manual_object_->begin("BaseWhiteNoLighting", Ogre::RenderOperation::OT_LINE_STRIP);
-          }
-          com_manual_object_->position(point_position.x, point_position.y, point_position.z);
-          com_manual_object_->colour(base_color);
-        } break;
-        case POINTS: {
-          if (i == 0) {
-            com_points_.clear();
-          }
-          float base_line_width = com_line_width_property_->getFloat();
-          // We are keeping a vector of CoM visual pointers. This creates the next
-          // one and stores it in the vector
-          boost::shared_ptr<PointVisual> point_visual;
-          point_visual.reset(new PointVisual(context_->getSceneManager(), scene_node_));
-          point_visual->setColor(base_color.r, base_color.g, base_color.b, base_color.a);
-          point_visual->setRadius(base_line_width);
-          point_visual->setPoint(com_position);
-          point_visual->setFramePosition(position);
-          point_visual->setFrameOrientation(orientation);
-          // And send it to the end of the vector
-          com_points_.push_back(point_visual);
-        } break;
-      }
-    }
-    if (base_style == LINES) {
-      com_manual_object_->end();
+    // Visualization of the base trajectory, which is skipped if it did not change
+    StageProfiler::ScopedTimer visual_timer(&profiler_, StageProfiler::VISUAL_UPDATE);
+    const SeriesSettings &settings = settings_.com;
+    if (updateSeriesGeometry(com_geometry_, com_knots_, settings.style, settings.color, settings.line_width)) {
+      updateSeriesAxes(com_geometry_, settings.axes_enable, settings.axes_scale, settings.color.a, settings.axes_max);
     }
   }
 }
 
 void WholeBodyTrajectoryDisplay::processContactTrajectory() {
-  if (contact_enable_) {
+  if (settings_.contact.enable) {
     // Lookup transform into fixed frame
     Ogre::Vector3 position;
     Ogre::Quaternion orientation;
-    if (!context_->getFrameManager()->getTransform(msg_->header, position, orientation)) {
+    StageProfiler::ScopedTimer transform_timer(&profiler_, StageProfiler::TRANSFORM_LOOKUP);
+    const bool has_transform = transform_cache_.getTransform(context_->getFrameManager(), msg_->header.frame_id,
+                                                             msg_->header.stamp, position, orientation);
+    transform_timer.stop();
+    if (!has_transform) {
       ROS_DEBUG("Error transforming from frame '%s' to frame '%s'", msg_->header.frame_id.c_str(),
                 qPrintable(fixed_frame_));
     }
-    Ogre::Matrix4 transform(orientation);
-    transform.setTrans(position);
 
-    // Visualization of the end-effector trajectory
-    // Getting the end-effector trajectory style
-    uint32_t n_points = msg_->trajectory.size();
-    LineStyle contact_style = (LineStyle)contact_style_property_->getOptionInt();
-
-    // Getting the end-effector trajectory color
-    Ogre::ColourValue contact_color = contact_color_property_->getOgreColor();
-    contact_color.a = contact_alpha_property_->getFloat();
-
-    // Getting the number of contact trajectories
-    std::size_t n_traj = 0;
-    std::map<std::string, std::size_t> contact_traj_id;
-    for (std::size_t i = 0; i < n_points; ++i) {
-      const whole_body_state_msgs::WholeBodyState &state = msg_->trajectory[i];
-      std::size_t n_contacts = state.contacts.size();
-      for (std::size_t k = 0; k < n_contacts; ++k) {
-        whole_body_state_msgs::ContactState contact = msg_->trajectory[i].contacts[k];
-        if (contact_traj_id.find(contact.name) == contact_traj_id.end()) {  // a new swing trajectory
-          contact_traj_id[contact.name] = n_traj;
-          // Incrementing the counter (id) of swing trajectories
-          ++n_traj;
-        }
+    // Sampling the different end-effector trajectories in the fixed frame
+    StageProfiler::ScopedTimer contact_timer(&profiler_, StageProfiler::CONTACT_LOOP);
+    sampleContactTrajectories(msg_->trajectory, Eigen::Vector3d(position.x, position.y, position.z),
+                              Eigen::Quaterniond(orientation.w, orientation.x, orientation.y, orientation.z),
+                              contact_knots_);
+    contact_timer.stop();
+
+    // Visualizing the different end-effector trajectories, which are skipped if they did not change
+    StageProfiler::ScopedTimer visual_timer(&profiler_, StageProfiler::VISUAL_UPDATE);
+    const SeriesSettings &settings = settings_.contact;
+    const std::size_t n_traj = contact_knots_.size();
+    contact_geometry_.resize(n_traj);
+    for (std::size_t i = 0; i < n_traj; ++i) {
+      if (updateSeriesGeometry(contact_geometry_[i], contact_knots_[i], settings.style, settings.color,
+                               settings.line_width)) {
+        updateSeriesAxes(contact_geometry_[i], settings.axes_enable, settings.axes_scale, settings.color.a,
+                         settings.axes_max);
       }
     }
+  }
+}
 
-    // Visualizing the different end-effector trajectories
-    contact_traj_id.clear();
-    contact_axes_.clear();
-    std::map<std::size_t, std::size_t> contact_vec_id;
-    float contact_line_width = contact_line_width_property_->getFloat();
-    switch (contact_style) {
-      case BILLBOARDS: {
-        // Getting the end-effector line width
-        contact_billboard_line_.clear();
-        contact_billboard_line_.resize(n_traj);
-      } break;
-      case LINES: {
-        contact_manual_object_.clear();
-        contact_manual_object_.resize(n_traj);
-      } break;
-      case POINTS: {
-        // Getting the end-effector line width
-        contact_points_.clear();
-        contact_points_.resize(n_points);
-      } break;
-    }
+bool WholeBodyTrajectoryDisplay::updateSeriesGeometry(SeriesGeometry &geometry, TrajectorySeries &knots,
+                                                      LineStyle style, const Ogre::ColourValue &color, float width) {
+  if (knots == geometry.knots) {
+    return false;
+  }
+  std::swap(geometry.knots, knots);
+  const std::size_t n_points = geometry.knots.size();
 
-    std::size_t traj_id = 0;
-    for (std::size_t i = 0; i < n_points; ++i) {
-      const whole_body_state_msgs::WholeBodyState &state = msg_->trajectory[i];
-      std::size_t n_contacts = state.contacts.size();
-      for (std::size_t k = 0; k < n_contacts; ++k) {
-        const whole_body_state_msgs::ContactState &contact = state.contacts[k];
-        if (contact_traj_id.find(contact.name) == contact_traj_id.end()) {  // a new swing trajectory
-          contact_traj_id[contact.name] = traj_id;
-          contact_vec_id[traj_id] = k;
-          switch (contact_style) {
-            case BILLBOARDS: {
-              contact_billboard_line_[traj_id].reset(new rviz::BillboardLine(scene_manager_, scene_node_));
-              contact_billboard_line_[traj_id]->setNumLines(1);
-              contact_billboard_line_[traj_id]->setMaxPointsPerLine(n_points);
-              contact_billboard_line_[traj_id]->setLineWidth(contact_line_width);
-            } break;
-            case LINES: {
-              contact_manual_object_[traj_id].reset(scene_manager_->createManualObject());
-              contact_manual_object_[traj_id]->setDynamic(true);
-              scene_node_->attachObject(contact_manual_object_[traj_id].get());
-              contact_manual_object_[traj_id]->estimateVertexCount(n_points);
-              contact_manual_object_[traj_id]->begin("BaseWhiteNoLighting", Ogre::RenderOperation::OT_LINE_STRIP);
-            } break;
-            case POINTS: {
-              // do nothing
-            } break;
-          }
-          // Incrementing the counter (id) of swing trajectories
-          ++traj_id;
-        } else {
-          std::size_t swing_idx = contact_traj_id.find(contact.name)->second;
-          if (k != contact_vec_id.find(swing_idx)->second) {  // change the vector index
-            contact_vec_id[swing_idx] = k;
-          }
-        }
+  switch (style) {
+    case BILLBOARDS: {
+      if (!geometry.billboard_line) {
+        geometry.billboard_line.reset(new rviz::BillboardLine(scene_manager_, scene_node_));
+        geometry.billboard_line->setNumLines(1);
+        geometry.billboard_capacity = 0;
       }
-      // Adding the contact points for the current swing trajectories
-      std::size_t contact_idx = 0;
-      if (contact_style == POINTS) {
-        // Updating the size
-        contact_points_[i].clear();
-        contact_points_[i].resize(n_contacts);
+      // The billboard chains are only reallocated when the horizon grows
+      if (n_points > geometry.billboard_capacity) {
+        geometry.billboard_line->setMaxPointsPerLine(n_points);
+        geometry.billboard_capacity = n_points;
       }
-      for (std::map<std::string, std::size_t>::iterator traj_it = contact_traj_id.begin();
-           traj_it != contact_traj_id.end(); ++traj_it) {
-        std::size_t traj_id = traj_it->second;
-        std::size_t id = contact_vec_id.find(traj_id)->second;
-        if (id < n_contacts) {
-          const whole_body_state_msgs::ContactState &contact = state.contacts[id];
-          Ogre::Vector3 contact_position;
-          Ogre::Quaternion contact_orientation;
-          contact_position.x = contact.pose.position.x;
-          contact_position.y = contact.pose.position.y;
-          contact_position.z = contact.pose.position.z;
-          contact_orientation.x = contact.pose.orientation.x;
-          contact_orientation.y = contact.pose.orientation.y;
-          contact_orientation.z = contact.pose.orientation.z;
-          contact_orientation.w = contact.pose.orientation.w;
-          // sanity check orientation
-          if (!(std::isfinite(contact_position.x) && std::isfinite(contact_position.y) &&
-                std::isfinite(contact_position.z))) {
-            std::cerr << "Contact trajectory is not finite, resetting to zero!" << std::endl;
-            contact_position.x = 0.0;
-            contact_position.y = 0.0;
-            contact_position.z = 0.0;
-          }
-          if (!(std::isfinite(contact_orientation.x) && std::isfinite(contact_orientation.y) &&
-                std::isfinite(contact_orientation.z) && std::isfinite(contact_orientation.w))) {
-            std::cerr << "Contact orientation is not finite, resetting to [0 0 0 1]" << std::endl;
-            contact_orientation.x = 0.;
-            contact_orientation.y = 0.;
-            contact_orientation.z = 0.;
-            contact_orientation.w = 1.;
-          }
-          Ogre::Vector3 point_position = transform * contact_position;
-          if (contact_axes_enable_) {
-            pushBackContactAxes(point_position, contact_orientation * orientation);
-          }
-          switch (contact_style) {
-            case BILLBOARDS: {
-              contact_billboard_line_[traj_id]->addPoint(point_position, contact_color);
-            } break;
-            case LINES: {
-              contact_manual_object_[traj_id]->position(point_position.x, point_position.y, point_position.z);
-              contact_manual_object_[traj_id]->colour(contact_color);
-            } break;
-            case POINTS: {
-              contact_points_[i][contact_idx].reset(new PointVisual(context_->getSceneManager(), scene_node_));
-              contact_points_[i][contact_idx]->setColor(contact_color.r, contact_color.g, contact_color.b,
-                                                        contact_color.a);
-              contact_points_[i][contact_idx]->setRadius(contact_line_width);
-              contact_points_[i][contact_idx]->setPoint(point_position);
-              contact_points_[i][contact_idx]->setFramePosition(position);
-              contact_points_[i][contact_idx]->setFrameOrientation(orientation);
-              ++contact_idx;
-            } break;
-          }
-        }
+      geometry.billboard_line->clear();
+      geometry.billboard_line->setLineWidth(width);
+      for (std::size_t i = 0; i < n_points; ++i) {
+        const Eigen::Vector3d &point_position = geometry.knots.positions[i];
+        geometry.billboard_line->addPoint(Ogre::Vector3(point_position.x(), point_position.y(), point_position.z()),
+                                          color);
       }
-    }
-
-    // Ending the contact manual objects
-    if (contact_style == LINES) {
-      for (std::size_t i = 0; i < traj_id; ++i) {
-        contact_manual_object_[i]->end();
+    } break;
+    case LINES: {
+      if (!geometry.manual_object) {
+        geometry.manual_object.reset(scene_manager_->createManualObject());
+        geometry.manual_object->setDynamic(true);
+        scene_node_->attachObject(geometry.manual_object.get());
       }
-    }
+      // The vertex buffer of an existing section is rewritten in place
+      geometry.manual_object->estimateVertexCount(n_points);
+      if (geometry.manual_object->getNumSections() == 0) {
+        geometry.manual_object->begin("BaseWhiteNoLighting", Ogre::RenderOperation::OT_LINE_STRIP);
+      } else {
+        geometry.manual_object->beginUpdate(0);
+      }
+      for (std::size_t i = 0; i < n_points; ++i) {
+        const Eigen::Vector3d &point_position = geometry.knots.positions[i];
+        geometry.manual_object->position(point_position.x(), point_position.y(), point_position.z());
+        geometry.manual_object->colour(color);
+      }
+      geometry.manual_object->end();
+    } break;
+    case POINTS: {
+      // All the knots are drawn by a single batched mesh
+      if (!geometry.points) {
+        geometry.points.reset(new PointListVisual(scene_manager_, scene_node_));
+      }
+      geometry.points->setColor(color.r, color.g, color.b, color.a);
+      geometry.points->setRadius(width);
+      geometry.points->setPoints(geometry.knots.positions);
+    } break;
   }
+  return true;
 }
 
 void WholeBodyTrajectoryDisplay::loadRobotModel() {
-  clearStatuses();
   context_->queueRender();
   std::string content;
   if (!update_nh_.getParam(robot_description_property_->getStdString(), content)) {
@@ -821,106 +588,124 @@ void WholeBodyTrajectoryDisplay::loadRobotModel() {
   if (content == robot_description_) {
     return;
   }
+  clearStatuses();
   robot_description_ = content;
-  urdf::Model descr;
-  if (!descr.initString(robot_description_)) {
-    clearRobotModel();
-    setStatus(StatusProperty::Error, "URDF", "Failed to parse URDF model");
+
+  // The URDF is parsed in the background, and the models are handed off by the render loop
+  model_loader_.load(robot_description_);
+  setStatus(StatusProperty::Warn, "URDF", "Loading");
+}
+
+void WholeBodyTrajectoryDisplay::handOffRobotModel() {
+  boost::shared_ptr<const urdf::Model> descr;
+  boost::shared_ptr<const pinocchio::Model> model;
+  std::string error_msg;
+  if (!model_loader_.getModel(descr, model, error_msg)) {
     return;
   }
-  try {
-    pinocchio::urdf::buildModelFromXML(robot_description_, pinocchio::JointModelFreeFlyer(), model_);
-  } catch (const std::invalid_argument &e) {
-    std::string error_msg = "Failed to instantiate model: ";
-    error_msg += e.what();
-    setStatus(StatusProperty::Error, "Pinocchio-URDFParser", QString::fromStdString(error_msg));
+  if (!model) {
+    clearRobotModel();
+    setStatus(StatusProperty::Error, "URDF", QString::fromStdString(error_msg));
     ROS_ERROR_STREAM(error_msg);  // This message is potentially quite detailed.
     return;
   }
-  data_ = pinocchio::Data(model_);
-  double gravity = model_.gravity.linear().norm();
-  weight_ = pinocchio::computeTotalMass(model_) * gravity;
-  robot_->load(descr);
+  model_ = model;
+  data_ = pinocchio::Data(*model_);
+  joint_mapper_.setModel(*model_);
+  link_frames_.setModel(*model_);
+  double gravity = model_->gravity.linear().norm();
+  weight_ = pinocchio::computeTotalMass(*model_) * gravity;
+  robot_->load(*descr);
   updateTargetEnable();
   setStatus(StatusProperty::Ok, "URDF", "URDF parsed OK");
+
+  // The latest message received while loading is displayed with the new model
+  if (msg_ != nullptr) {
+    has_new_msg_ = true;
+  }
 }
 
 void WholeBodyTrajectoryDisplay::clearRobotModel() {
   robot_->clear();
   clearStatuses();
   robot_description_.clear();
-  model_ = pinocchio::Model();
+  model_loader_.cancel();
+  model_.reset();
   data_ = pinocchio::Data();
+  joint_mapper_.clear();
+  link_frames_.clear();
 }
 
 void WholeBodyTrajectoryDisplay::destroyObjects() {
-  com_manual_object_.reset();
-  com_billboard_line_.reset();
-  com_points_.clear();
-  com_axes_.clear();
-  contact_manual_object_.clear();
-  contact_billboard_line_.clear();
-  for (std::size_t i = 0; i < contact_points_.size(); ++i) {
-    contact_points_[i].clear();
+  com_geometry_ = SeriesGeometry();
+  contact_geometry_.clear();
+}
+
+void WholeBodyTrajectoryDisplay::applySettings(unsigned int groups) {
+  // The geometry rebuilt by a new message already takes the settings
+  const bool reprocess = msg_ != nullptr && !has_new_msg_;
+  if (groups & Settings::FORCE_APPEARANCE) {
+    const Ogre::ColourValue &color = settings_.force_color;
+    for (std::size_t i = 0; i < force_visual_.size(); ++i) {
+      force_visual_[i]->setColor(color.r, color.g, color.b, color.a);
+    }
+  }
+  if ((groups & Settings::FORCE_GEOMETRY) && reprocess) {
+    processTargetPosture();
+  }
+  if (groups & Settings::COM_APPEARANCE) {
+    if (settings_.com.style == LINES) {
+      // The colors are stored in the vertices, so the trajectory is processed again
+      com_geometry_.knots.clear();
+      if (reprocess) processCoMTrajectory();
+    } else {
+      applySeriesSettings(com_geometry_, settings_.com);
+    }
   }
-  contact_points_.clear();
-  contact_axes_.clear();
-}
-
-void WholeBodyTrajectoryDisplay::pushBackCoMAxes(const Ogre::Vector3 &axes_position,
-                                                 const Ogre::Quaternion &axes_orientation) {
-  // We are keeping a vector of CoM frame pointers. This creates the next
-  // one and stores it in the vector
-  float scale = com_scale_property_->getFloat();
-  // Adding the frame with a distant from the last one
-  float sq_distant = axes_position.squaredDistance(last_point_position_);
-  if (sq_distant >= scale * scale * 0.0032) {
-    boost::shared_ptr<rviz::Axes> axes;
-    axes.reset(new Axes(scene_manager_, scene_node_, 0.04, 0.008));
-    axes->setPosition(axes_position);
-    axes->setOrientation(axes_orientation);
-    Ogre::ColourValue x_color = axes->getDefaultXColor();
-    Ogre::ColourValue y_color = axes->getDefaultYColor();
-    Ogre::ColourValue z_color = axes->getDefaultZColor();
-    x_color.a = com_alpha_property_->getFloat();
-    y_color.a = com_alpha_property_->getFloat();
-    z_color.a = com_alpha_property_->getFloat();
-    axes->setXColor(x_color);
-    axes->setYColor(y_color);
-    axes->setZColor(z_color);
-    axes->getSceneNode()->setVisible(true);
-    axes->setScale(Ogre::Vector3(scale, scale, scale));
-    com_axes_.push_back(axes);
-    last_point_position_ = axes_position;
+  if (groups & Settings::CONTACT_APPEARANCE) {
+    if (settings_.contact.style == LINES) {
+      // The colors are stored in the vertices, so the trajectories are processed again
+      for (std::size_t i = 0; i < contact_geometry_.size(); ++i) {
+        contact_geometry_[i].knots.clear();
+      }
+      if (reprocess) processContactTrajectory();
+    } else {
+      for (std::size_t i = 0; i < contact_geometry_.size(); ++i) {
+        applySeriesSettings(contact_geometry_[i], settings_.contact);
+      }
+    }
   }
 }
 
-void WholeBodyTrajectoryDisplay::pushBackContactAxes(const Ogre::Vector3 &axes_position,
-                                                     const Ogre::Quaternion &axes_orientation) {
-  // We are keeping a vector of contact frame pointers. This creates the next
-  // one and stores it in the vector
-  float scale = contact_scale_property_->getFloat();
-  // Adding the frame with a distant from the last one
-  float sq_distant = axes_position.squaredDistance(last_point_position_);
-  if (sq_distant >= scale * scale * 0.0032) {
-    boost::shared_ptr<rviz::Axes> axes;
-    axes.reset(new Axes(scene_manager_, scene_node_, 0.04, 0.008));
-    axes->setPosition(axes_position);
-    axes->setOrientation(axes_orientation);
-    Ogre::ColourValue x_color = axes->getDefaultXColor();
-    Ogre::ColourValue y_color = axes->getDefaultYColor();
-    Ogre::ColourValue z_color = axes->getDefaultZColor();
-    x_color.a = com_alpha_property_->getFloat();
-    y_color.a = com_alpha_property_->getFloat();
-    z_color.a = com_alpha_property_->getFloat();
-    axes->setXColor(x_color);
-    axes->setYColor(y_color);
-    axes->setZColor(z_color);
-    axes->getSceneNode()->setVisible(true);
-    axes->setScale(Ogre::Vector3(scale, scale, scale));
-    contact_axes_.push_back(axes);
-    last_point_position_ = axes_position;
+void WholeBodyTrajectoryDisplay::applySeriesSettings(SeriesGeometry &geometry, const SeriesSettings &settings) {
+  const Ogre::ColourValue &color = settings.color;
+  if (geometry.billboard_line) {
+    geometry.billboard_line->setLineWidth(settings.line_width);
+    geometry.billboard_line->setColor(color.r, color.g, color.b, color.a);
+  }
+  if (geometry.points) {
+    geometry.points->setColor(color.r, color.g, color.b, color.a);
+    geometry.points->setRadius(settings.line_width);
+  }
+  updateSeriesAxes(geometry, settings.axes_enable, settings.axes_scale, color.a, settings.axes_max);
+}
+
+void WholeBodyTrajectoryDisplay::updateSeriesAxes(SeriesGeometry &geometry, bool enable, float scale, float alpha,
+                                                  std::size_t max_axes) {
+  if (!enable || geometry.knots.positions.empty()) {
+    geometry.axes.reset();
+    return;
+  }
+
+  sampleAxes(geometry.knots, scale, max_axes, sampled_axes_);
+
+  // All the frames of the series are drawn by a single line list
+  if (!geometry.axes) {
+    geometry.axes.reset(new AxesListVisual(scene_manager_, scene_node_));
   }
+  geometry.axes->setLength(0.04 * scale);
+  geometry.axes->setAlpha(alpha);
+  geometry.axes->setAxes(sampled_axes_);
 }
 
 }  // namespace whole_body_state_rviz_plugin